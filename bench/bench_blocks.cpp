@@ -0,0 +1,75 @@
+//============================================================================
+// Name        : bench_blocks.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Walk a deep tree with get_blocks (copies each level) and with get_blocks_view (references).
+// build : g++ -std=c++17 -O2 -I../src bench_blocks.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [depth=6] [fan_out=6]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//depth levels of "node" blocks, each with fan_out children and two values
+	void make_tree(std::ostream &out, size_t depth, size_t fan_out){
+		out << "name = n" << depth << "\n";
+		out << "size = " << depth*10 << "\n";
+		if(depth==0){return;}
+		for(size_t i=0;i<fan_out;++i){
+			out << "node{\n";
+			make_tree(out,depth-1,fan_out);
+			out << "}\n";
+		}
+	}
+
+	size_t walk_copy(const BConfig &b){
+		size_t n = b.get_unique_value<size_t>("size");
+		for(const BConfig &c : b.get_blocks("node",false)){n+=walk_copy(c);}
+		return n;
+	}
+
+	size_t walk_view(const BConfig &b){
+		size_t n = b.get_unique_value<size_t>("size");
+		for(const BConfig &c : b.get_blocks_view("node",false)){n+=walk_view(c);}
+		return n;
+	}
+
+	template<typename F>
+	double time_ms(F f, size_t &result){
+		auto t0 = std::chrono::steady_clock::now();
+		result = f();
+		auto t1 = std::chrono::steady_clock::now();
+		return std::chrono::duration<double,std::milli>(t1-t0).count();
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t depth   = argc>1 ? std::strtoul(argv[1],nullptr,10) : 6;
+	const size_t fan_out = argc>2 ? std::strtoul(argv[2],nullptr,10) : 6;
+
+	std::stringstream text;
+	make_tree(text,depth,fan_out);
+	BConfig root(text,"generated");
+
+	size_t r_copy=0, r_view=0;
+	double ms_copy = time_ms([&]{return walk_copy(root);},r_copy);
+	double ms_view = time_ms([&]{return walk_view(root);},r_view);
+
+	std::cout << "depth="<<depth<<" fan_out="<<fan_out<<" bytes="<<text.str().size()<<"\n";
+	std::cout << "get_blocks      : " << ms_copy << " ms\n";
+	std::cout << "get_blocks_view : " << ms_view << " ms\n";
+	if(r_copy!=r_view){std::cerr << "mismatch\n"; return 1;}
+	return 0;
+}
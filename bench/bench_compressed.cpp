@@ -0,0 +1,77 @@
+//============================================================================
+// Name        : bench_compressed.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Load a gzip file : decompress then parse (one after the other), and the pipelined parse of BConfig::parse(path).
+// The pipelined time tends to max(decompress, parse) when there are at least 2 cores, instead of their sum.
+// build : g++ -std=c++17 -O2 -pthread -DBCONFIG_ZLIB -I../src bench_compressed.cpp ../src/BConfig.cpp ../src/helpers/*.cpp -lz
+// usage : ./a.out [size_mb=100] [shape=multi] [file=/tmp/bench_compressed.gz]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <zlib.h>
+#include "BConfig.hpp"
+#include "helpers/CompressedFile.h"
+#include "bench_generator.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	template<typename F>
+	double time_ms(F f){
+		auto t0 = std::chrono::steady_clock::now();
+		f();
+		return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+	}
+
+	void write_gz(const std::string &path, const std::string &text){
+		gzFile f = gzopen(path.c_str(),"wb6");
+		if(f==nullptr or gzwrite(f,text.data(),static_cast<unsigned>(text.size()))!=static_cast<int>(text.size())){
+			std::cerr << "cannot write " << path << "\n";
+			std::exit(1);
+		}
+		gzclose(f);
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t      size_mb = argc>1 ? std::strtoul(argv[1],nullptr,10) : 100;
+	const std::string shape   = argc>2 ? argv[2] : "multi";
+	const std::string path    = argc>3 ? argv[3] : "/tmp/bench_compressed.gz";
+
+	bench::Shape s = bench::Shape::multi;
+	if(shape=="wide"    ){s=bench::Shape::wide;}
+	if(shape=="deep"    ){s=bench::Shape::deep;}
+	if(shape=="repeated"){s=bench::Shape::repeated;}
+	if(shape=="numeric" ){s=bench::Shape::numeric;}
+
+	const std::string text = bench::generate(s,size_mb<<20,1);
+	write_gz(path,text);
+	std::cout << "input " << text.size()/(1024*1024) << " MB, " << shape << ", " << std::thread::hardware_concurrency() << " cores\n";
+
+	std::string decompressed;
+	const double t_decompress = time_ms([&](){decompressed = CompressedFile(path,CompressedFile::Format::gzip).read_all();});
+
+	double t_parse = time_ms([&](){
+		std::istringstream in(std::move(decompressed));
+		BConfig b(in,path);
+	});
+
+	BConfig pipelined;
+	const double t_pipelined = time_ms([&](){pipelined = BConfig(path);});
+
+	std::cout << "decompress " << t_decompress << " ms\tparse " << t_parse << " ms\tsum " << t_decompress+t_parse << " ms\n";
+	std::cout << "pipelined  " << t_pipelined  << " ms\t" << (text.size()/(1024.*1024.))/(t_pipelined/1000) << " MB/s\n";
+	return 0;
+}
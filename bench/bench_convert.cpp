@@ -0,0 +1,68 @@
+//============================================================================
+// Name        : bench_convert.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Compare the std::stringstream conversion (old Convert_t) with bconfig::convert (std::from_chars).
+// build : g++ -std=c++17 -O2 -I../src bench_convert.cpp
+// usage : ./a.out [iterations=1000000]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "BConfig_convert.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//the conversion used by Convert_t before std::from_chars
+	template<typename T>
+	T convert_stringstream(const std::string &s){
+		T R;
+		std::stringstream strStream(s);
+		strStream >> R;
+		return R;
+	}
+
+	template<typename F>
+	double time_ns(const std::vector<std::string> &input, size_t iterations, F f){
+		double sink=0;
+		auto t0 = std::chrono::steady_clock::now();
+		for(size_t i=0;i<iterations;++i){sink += static_cast<double>(f(input[i%input.size()]));}
+		auto t1 = std::chrono::steady_clock::now();
+		if(sink==-1){std::cout << sink;} //keep the result alive
+		return std::chrono::duration<double,std::nano>(t1-t0).count()/static_cast<double>(iterations);
+	}
+
+	template<typename T>
+	void run(const char *name, const std::vector<std::string> &input, size_t iterations){
+		double ns_old = time_ns(input,iterations,[](const std::string &s){return convert_stringstream<T>(s);});
+		double ns_new = time_ns(input,iterations,[](const std::string &s){return bconfig::convert<T>(std::string_view(s));});
+		std::cout << name << "\tstringstream " << ns_old << " ns\tfrom_chars " << ns_new << " ns\tspeedup " << ns_old/ns_new << "\n";
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t iterations = argc>1 ? std::strtoul(argv[1],nullptr,10) : 1000000;
+
+	std::vector<std::string> integers, reals;
+	for(size_t i=0;i<1024;++i){
+		integers.push_back(std::to_string(i*7919%1000003));
+		reals   .push_back(std::to_string(static_cast<double>(i)*3.14159/7.0));
+	}
+
+	run<int   >("int   ",integers,iterations);
+	run<size_t>("size_t",integers,iterations);
+	run<float >("float ",reals   ,iterations);
+	run<double>("double",reals   ,iterations);
+	return 0;
+}
@@ -0,0 +1,87 @@
+//============================================================================
+// Name        : bench_deep.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Parse time of deeply nested inputs : one chain of nested blocks of growing depth, and growing inputs made of chains of 64 levels.
+// Sub-blocks are built in place and never copied, so the time per level and per line stay flat when the input grows.
+// Then get_blocks on a tree (copies the sub-blocks) and on a temporary (moves them).
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_deep.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [max_depth=8192] [max_size_mb=32]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "BConfig.hpp"
+#include "bench_generator.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//best of 3, f returns what it built : it is released outside of the timing
+	template<typename F>
+	double best_ms(F f){
+		double R=0;
+		for(int i=0;i<3;++i){
+			auto t0 = std::chrono::steady_clock::now();
+			auto built = f();
+			const double ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+			R = i==0 ? ms : std::min(R,ms);
+		}
+		return R;
+	}
+
+	//one chain of depth nested blocks, not indented : the text grows linearly with depth
+	std::string chain(size_t depth){
+		std::string R;
+		for(size_t d=0;d<depth;++d){R += "level{\nname = n" + std::to_string(d) + "\n";}
+		for(size_t d=0;d<depth;++d){R += "}\n";}
+		return R;
+	}
+
+	BConfig parse(const std::string &text){
+		std::istringstream in(text);
+		return BConfig(in,"bench");
+	}
+
+	size_t count_lines(const std::string &text){return static_cast<size_t>(std::count(text.begin(),text.end(),'\n'));}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t max_depth   = argc>1 ? std::strtoul(argv[1],nullptr,10) : 8192;
+	const size_t max_size_mb = argc>2 ? std::strtoul(argv[2],nullptr,10) : 32;
+
+	//the destructor of a chain recurses once per level : keep max_depth within the stack
+	std::cout << "one chain\n";
+	for(size_t depth=max_depth/8; depth<=max_depth; depth*=2){
+		const std::string text = chain(depth);
+		const double ms = best_ms([&](){return parse(text);});
+		std::cout << "depth " << depth << "\t" << ms << " ms\t" << ms*1e6/depth << " ns/level\n";
+	}
+
+	std::cout << "chains of 64 levels\n";
+	for(size_t mb=std::max<size_t>(1,max_size_mb/8); mb<=max_size_mb; mb*=2){
+		const std::string text = bench::generate(bench::Shape::deep,mb<<20,1);
+		const double ms = best_ms([&](){return parse(text);});
+		std::cout << mb << " MB\t" << ms << " ms\t" << ms*1e6/count_lines(text) << " ns/line\n";
+	}
+
+	std::cout << "get_blocks, " << max_size_mb << " MB of chains of 64 levels\n";
+	const std::string text = bench::generate(bench::Shape::deep,max_size_mb<<20,1);
+	const double copied = best_ms([&](){
+		BConfig b = parse(text);
+		return b.get_blocks("level");
+	});
+	const double moved = best_ms([&](){return parse(text).get_blocks("level");});
+	std::cout << "parse then copy\t" << copied << " ms\nparse then move\t" << moved << " ms\n";
+	return 0;
+}
@@ -0,0 +1,115 @@
+//============================================================================
+// Name        : bench_generator.hpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Deterministic synthetic configuration files for the benchmarks.
+// The same (shape, size, seed) always gives the same text, on every platform : the random numbers come from splitmix64,
+// not from the <random> distributions whose output depends on the standard library.
+
+#ifndef BENCH_GENERATOR_HPP_
+#define BENCH_GENERATOR_HPP_
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+
+namespace bench{
+
+	enum class Shape{
+		wide,     //one level, many distinct keys with one value each
+		deep,     //chains of nested blocks
+		repeated, //many top-level blocks with the same key and the same layout
+		multi,    //a few keys, each with a long list of values
+		numeric   //large integers and floating point values
+	};
+
+	inline const char *shape_name(Shape s){
+		switch(s){
+			case Shape::wide    : return "wide";
+			case Shape::deep    : return "deep";
+			case Shape::repeated: return "repeated";
+			case Shape::multi   : return "multi";
+			case Shape::numeric : return "numeric";
+		}
+		return "";
+	}
+
+
+	struct Random{
+		uint64_t state;
+		explicit Random(uint64_t seed):state(seed){}
+
+		uint64_t next(){
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z>>27)) * 0x94d049bb133111ebull;
+			return z ^ (z>>31);
+		}
+
+		uint64_t below(uint64_t n){return next()%n;}
+
+		std::string word(size_t min_size, size_t max_size){
+			std::string R(min_size+below(max_size-min_size+1),' ');
+			for(char &c : R){c = static_cast<char>('a'+below(26));}
+			return R;
+		}
+	};
+
+
+	/**\brief a configuration of about bytes bytes (never less) of the given shape*/
+	inline std::string generate(Shape shape, size_t bytes, uint64_t seed=42){
+		Random r(seed);
+		std::ostringstream out;
+		size_t n=0;
+
+		auto size = [&](){return static_cast<size_t>(out.tellp());};
+
+		switch(shape){
+			case Shape::wide :
+				while(size()<bytes){out << "key_" << n++ << " = " << r.word(4,24) << "\n";}
+				break;
+
+			case Shape::deep :
+				//chains of 64 nested levels, each level has a few values
+				while(size()<bytes){
+					const size_t depth=64;
+					for(size_t d=0;d<depth;++d){
+						out << std::string(d,' ') << "level{\n";
+						out << std::string(d+1,' ') << "name = " << r.word(4,12) << "\n";
+						out << std::string(d+1,' ') << "depth = " << d << "\n";
+					}
+					for(size_t d=depth;d-->0;){out << std::string(d,' ') << "}\n";}
+					++n;
+				}
+				break;
+
+			case Shape::repeated :
+				while(size()<bytes){
+					out << "item{\n  id = " << n++ << "\n  name = " << r.word(6,16) << "\n";
+					out << "  enabled = " << (r.below(2) ? "yes" : "no") << "\n  weight = " << r.below(1000) << "\n";
+					out << "  owner{\n    name = " << r.word(4,10) << "\n  }\n}\n";
+				}
+				break;
+
+			case Shape::multi :
+				//8 keys, values added round robin so that each list grows evenly
+				while(size()<bytes){out << "list_" << n++%8 << " = " << r.word(16,64) << "\n";}
+				break;
+
+			case Shape::numeric :
+				while(size()<bytes){
+					out << "int_"   << n   << " = " << static_cast<int64_t>(r.next()>>1) << "\n";
+					out << "float_" << n++ << " = " << r.below(1000000) << "." << r.below(1000000) << "e" << r.below(200) << "\n";
+				}
+				break;
+		}
+		return out.str();
+	}
+
+}//end namespace bench
+
+#endif /* BENCH_GENERATOR_HPP_ */
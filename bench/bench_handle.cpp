@@ -0,0 +1,104 @@
+//============================================================================
+// Name        : bench_handle.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Read throughput of threads that look up a value while a writer publishes a new version every millisecond :
+//  - mutex      : a BConfig guarded by a std::mutex
+//  - atomic_load: a Snapshot loaded with std::atomic_load at each read
+//  - handle     : Handle::read with a Handle::Reader per thread
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_handle.cpp ../src/BConfig.cpp ../src/BConfig_handle.cpp ../src/helpers/*.cpp
+// usage : ./a.out [threads=4] [milliseconds=1000]
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "BConfig_handle.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	BConfig make_config(size_t version){
+		std::ostringstream out;
+		out << "version = " << version << "\nthreads = 8\n";
+		for(size_t i=0;i<64;++i){out << "key" << i << " = " << i << "\n";}
+		out << "pool{\n  size = 16\n}\n";
+		std::istringstream in(out.str());
+		return BConfig(in,"bench");
+	}
+
+	//run threads readers for ms milliseconds while a writer calls publish(version), return reads per second.
+	//make_reader() returns the lookup of a thread, which keeps its own state
+	template<typename Make_reader, typename Publish>
+	double run(size_t threads, size_t ms, Make_reader make_reader, Publish publish){
+		std::atomic<bool>   stop(false);
+		std::atomic<size_t> reads(0);
+
+		std::vector<std::thread> pool;
+		for(size_t t=0;t<threads;++t){
+			pool.emplace_back([&](){
+				auto lookup = make_reader();
+				size_t n=0, sink=0;
+				while(!stop.load(std::memory_order_relaxed)){
+					for(size_t i=0;i<64;++i){sink += lookup();}
+					n+=64;
+				}
+				reads += n + (sink==0 ? 1 : 0);
+			});
+		}
+
+		auto t0 = std::chrono::steady_clock::now();
+		for(size_t v=1; std::chrono::steady_clock::now()-t0 < std::chrono::milliseconds(ms); ++v){
+			publish(v);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		stop = true;
+		for(std::thread &t : pool){t.join();}
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+		return static_cast<double>(reads.load())/s;
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t threads = argc>1 ? std::strtoul(argv[1],nullptr,10) : 4;
+	const size_t ms      = argc>2 ? std::strtoul(argv[2],nullptr,10) : 1000;
+
+	//mutex
+	{
+		std::mutex m;
+		BConfig    b = make_config(0);
+		double r = run(threads,ms,
+			[&](){return [&](){std::lock_guard<std::mutex> lock(m); return b.get_value_view("threads").size();};},
+			[&](size_t v){BConfig n = make_config(v); std::lock_guard<std::mutex> lock(m); b=std::move(n);});
+		std::cout << "mutex      \t" << r/1e6 << " M reads/s\n";
+	}
+	//atomic_load
+	{
+		Snapshot s = freeze(make_config(0));
+		double r = run(threads,ms,
+			[&](){return [&](){Snapshot keep = std::atomic_load(&s); return keep->get_value_view("threads").size();};},
+			[&](size_t v){std::atomic_store(&s,freeze(make_config(v)));});
+		std::cout << "atomic_load\t" << r/1e6 << " M reads/s\n";
+	}
+
+	//handle
+	{
+		Handle h(freeze(make_config(0)));
+		double r = run(threads,ms,
+			[&](){return [&, reader=Handle::Reader()]() mutable {return h.read(reader).get_value_view("threads").size();};},
+			[&](size_t v){h.publish(freeze(make_config(v)));});
+		std::cout << "handle     \t" << r/1e6 << " M reads/s\n";
+	}
+	return 0;
+}
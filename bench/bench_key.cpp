@@ -0,0 +1,62 @@
+//============================================================================
+// Name        : bench_key.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Compare lookups with a key given as text (hashed at each call) and with a _key literal (hashed at compile time).
+// build : g++ -std=c++17 -O2 -I../src bench_key.cpp ../src/BConfig.cpp ../src/helpers/*.cpp -lpthread
+// usage : ./a.out [iterations=10000000]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+using namespace bconfig::literals;
+
+
+namespace{
+
+	template<typename F>
+	double time_ns(size_t iterations, F f){
+		size_t sink=0;
+		auto t0 = std::chrono::steady_clock::now();
+		for(size_t i=0;i<iterations;++i){sink += f();}
+		auto t1 = std::chrono::steady_clock::now();
+		if(sink==1){std::cout << sink;} //keep the result alive
+		return std::chrono::duration<double,std::nano>(t1-t0).count()/static_cast<double>(iterations);
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t iterations = argc>1 ? std::strtoul(argv[1],nullptr,10) : 10000000;
+
+	//a request handler block : a few dozen keys, some of them long
+	std::ostringstream s;
+	s << "listen_address_and_port_of_the_server=0.0.0.0:8080\nmax_request_body_size=1048576\nsize=10\n";
+	for(size_t i=0;i<40;++i){s << "option_" << i << "=" << i << "\n";}
+	std::istringstream in(s.str());
+	BConfig b(in,"bench");
+
+	static constexpr Key long_k = "listen_address_and_port_of_the_server"_key;
+
+	double ns_text = time_ns(iterations,[&](){return b.get_unique_value<size_t>("size");});
+	double ns_key  = time_ns(iterations,[&](){return b.get_unique_value<size_t>("size"_key);});
+	std::cout << "short key\ttext " << ns_text << " ns\t_key " << ns_key << " ns\tspeedup " << ns_text/ns_key << "\n";
+
+	ns_text = time_ns(iterations,[&](){return b.get_value_view("listen_address_and_port_of_the_server").size();});
+	ns_key  = time_ns(iterations,[&](){return b.get_value_view(long_k).size();});
+	std::cout << "long key\ttext " << ns_text << " ns\t_key " << ns_key << " ns\tspeedup " << ns_text/ns_key << "\n";
+
+	ns_text = time_ns(iterations,[&](){return b.count_values("missing_key");});
+	ns_key  = time_ns(iterations,[&](){return b.count_values("missing_key"_key);});
+	std::cout << "missing key\ttext " << ns_text << " ns\t_key " << ns_key << " ns\tspeedup " << ns_text/ns_key << "\n";
+	return 0;
+}
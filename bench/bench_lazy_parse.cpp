@@ -0,0 +1,66 @@
+//============================================================================
+// Name        : bench_lazy_parse.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Load many top-level blocks and read a few percent of them, with an eager parse and with Parse_options::lazy.
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_lazy_parse.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [blocks=200000] [read_percent=5]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	std::string make_input(size_t blocks){
+		std::ostringstream out;
+		for(size_t i=0;i<blocks;++i){
+			out << "service{\n  name = s" << i << "\n  port = " << 1024+i%50000 << "\n";
+			out << "  limits{\n    cpu = " << i%8+1 << "\n    memory = " << (i%16+1)*256 << "\n  }\n";
+			out << "  backend{\n    host = h" << i%97 << "\n    weight = 3\n  }\n  backend{\n    host = h" << i%89 << "\n    weight = 1\n  }\n}\n";
+		}
+		return out.str();
+	}
+
+	void run(const char *name, const std::string &text, const Parse_options &opt, size_t read_percent){
+		std::istringstream in(text);
+		auto t0 = std::chrono::steady_clock::now();
+		BConfig b(in,"bench",opt);
+		auto t1 = std::chrono::steady_clock::now();
+
+		size_t sum=0, i=0;
+		for(const BConfig &s : b.get_blocks_view("service")){
+			if(i++%100 >= read_percent){continue;}
+			sum += s.get_unique_block_ref("limits").get_unique_value<size_t>("memory");
+			for(const BConfig &k : s.get_blocks_view("backend")){sum += k.get_unique_value<size_t>("weight");}
+		}
+		auto t2 = std::chrono::steady_clock::now();
+
+		std::cout << name << "\tload " << std::chrono::duration<double,std::milli>(t1-t0).count() << " ms"
+		          << "\tread " << std::chrono::duration<double,std::milli>(t2-t1).count() << " ms\t(" << sum << ")\n";
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t blocks       = argc>1 ? std::strtoul(argv[1],nullptr,10) : 200000;
+	const size_t read_percent = argc>2 ? std::strtoul(argv[2],nullptr,10) : 5;
+
+	const std::string text = make_input(blocks);
+	std::cout << "input " << text.size()/(1024*1024) << " MB, reading " << read_percent << "% of the blocks\n";
+
+	Parse_options eager, lazy;
+	lazy.lazy = true;
+	run("eager",text,eager,read_percent);
+	run("lazy ",text,lazy ,read_percent);
+	return 0;
+}
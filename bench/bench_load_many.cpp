@@ -0,0 +1,76 @@
+//============================================================================
+// Name        : bench_load_many.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Load many small files one BConfig(path) at a time, and with load_many on 1, 2, 4 ... up to max_threads threads.
+// The files are written first, so they are in the page cache.
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_load_many.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [files=500] [size_kb=8] [max_threads=hardware_concurrency] [dir=/tmp/bench_load_many]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/stat.h>
+#include "BConfig.hpp"
+#include "bench_generator.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//best of 3 runs, f returns what it loaded : it is released outside of the timing
+	template<typename F>
+	double best_ms(F f){
+		double R=0;
+		for(int i=0;i<3;++i){
+			auto t0 = std::chrono::steady_clock::now();
+			auto loaded = f();
+			const double ms = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-t0).count();
+			R = i==0 ? ms : std::min(R,ms);
+		}
+		return R;
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t      files       = argc>1 ? std::strtoul(argv[1],nullptr,10) : 500;
+	const size_t      size_kb     = argc>2 ? std::strtoul(argv[2],nullptr,10) : 8;
+	const unsigned    max_threads = argc>3 ? static_cast<unsigned>(std::strtoul(argv[3],nullptr,10)) : std::max(1u,std::thread::hardware_concurrency());
+	const std::string dir         = argc>4 ? argv[4] : "/tmp/bench_load_many";
+
+	::mkdir(dir.c_str(),0755);
+	std::vector<std::string> paths;
+	for(size_t i=0;i<files;++i){
+		paths.push_back(dir+"/tenant_"+std::to_string(i)+".conf");
+		std::ofstream(paths.back()) << bench::generate(bench::Shape::repeated,size_kb<<10,i);
+	}
+	std::cout << files << " files of " << size_kb << " KB\n";
+
+	//the trees are kept, as a service keeps its configurations
+	const double sequential = best_ms([&](){
+		std::vector<BConfig> R;
+		R.reserve(paths.size());
+		for(const std::string &p : paths){R.emplace_back(p);}
+		return R;
+	});
+	std::cout << "BConfig(path) loop\t" << sequential << " ms\n";
+
+	for(unsigned t=1; t<=max_threads; t*=2){
+		Parse_options opt;
+		opt.threads = t;
+		const double ms = best_ms([&](){return load_many(paths,opt);});
+		std::cout << "load_many " << t << " threads\t" << ms << " ms\tx" << sequential/ms << "\n";
+	}
+	return 0;
+}
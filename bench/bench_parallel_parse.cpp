@@ -0,0 +1,61 @@
+//============================================================================
+// Name        : bench_parallel_parse.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Parse many independent top-level blocks with Parse_options::threads = 1, 2, 4 ... up to max_threads.
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_parallel_parse.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [blocks=200000] [max_threads=hardware_concurrency]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//blocks "tree" blocks like the ones of doc-web/example.conf
+	std::string make_input(size_t blocks){
+		std::ostringstream out;
+		for(size_t i=0;i<blocks;++i){
+			out << "tree{\n  name = tree " << i << "\n  trunk{\n    size = " << i%97 << "\n    type = big\n  }\n";
+			out << "  branch{\n    broken = no\n    leave{\n      color = yellow\n    }\n  }\n}\n";
+		}
+		return out.str();
+	}
+
+	double parse_ms(const std::string &text, unsigned threads, size_t &blocks){
+		Parse_options opt;
+		opt.threads = threads;
+		std::istringstream in(text);
+		auto t0 = std::chrono::steady_clock::now();
+		BConfig b(in,"bench",opt);
+		auto t1 = std::chrono::steady_clock::now();
+		blocks = b.count_blocks("tree");
+		return std::chrono::duration<double,std::milli>(t1-t0).count();
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t   blocks      = argc>1 ? std::strtoul(argv[1],nullptr,10) : 200000;
+	const unsigned max_threads = argc>2 ? static_cast<unsigned>(std::strtoul(argv[2],nullptr,10)) : std::max(1u,std::thread::hardware_concurrency());
+
+	const std::string text = make_input(blocks);
+	std::cout << "input " << text.size()/(1024*1024) << " MB\n";
+
+	for(unsigned t=1; t<=max_threads; t*=2){
+		size_t found=0;
+		double ms = parse_ms(text,t,found);
+		std::cout << "threads " << t << "\t" << ms << " ms\t" << found << " blocks\n";
+	}
+	return 0;
+}
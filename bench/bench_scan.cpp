@@ -0,0 +1,119 @@
+//============================================================================
+// Name        : bench_scan.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Throughput of the structural scanner (detail::find_structurals) at each instruction set level,
+// of the event parser line by line (detail::parse_line on each character) and with the scanner, and of a whole BConfig parse.
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_scan.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// usage : ./a.out [size_mb=64] [shape=wide]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "BConfig.hpp"
+#include "BConfig_events.hpp"
+#include "bench_generator.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	//counts the events, so that the parse is not optimized away
+	struct Count_handler{
+		size_t n=0;
+		void on_value(std::string_view k, std::string_view v){n+=k.size()+v.size();}
+		void on_open_block(std::string_view k){n+=k.size();}
+		void on_close_block(){++n;}
+		void on_empty_block(std::string_view k){n+=k.size();}
+	};
+
+	//best of 3, in GB/s
+	template<typename F>
+	double gbps(size_t bytes, F f){
+		double best=0;
+		for(int i=0;i<3;++i){
+			auto t0 = std::chrono::steady_clock::now();
+			f();
+			const double s = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+			best = std::max(best,bytes/s/1e9);
+		}
+		return best;
+	}
+
+	const char *level_name(detail::Scan_level l){
+		switch(l){
+			case detail::Scan_level::scalar : return "scalar";
+			case detail::Scan_level::sse2   : return "sse2";
+			case detail::Scan_level::avx2   : return "avx2";
+		}
+		return "";
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t      size_mb = argc>1 ? std::strtoul(argv[1],nullptr,10) : 64;
+	const std::string shape   = argc>2 ? argv[2] : "wide";
+
+	bench::Shape s = bench::Shape::wide;
+	if(shape=="deep"    ){s=bench::Shape::deep;}
+	if(shape=="repeated"){s=bench::Shape::repeated;}
+	if(shape=="multi"   ){s=bench::Shape::multi;}
+	if(shape=="numeric" ){s=bench::Shape::numeric;}
+
+	const std::string text = bench::generate(s,size_mb<<20,1);
+	std::cout << "input " << text.size()/(1024*1024) << " MB, " << shape << ", best level " << level_name(detail::scan_level()) << "\n";
+
+	static uint16_t index[detail::scan_chunk];
+	size_t sink=0;
+	for(detail::Scan_level l : {detail::Scan_level::scalar,detail::Scan_level::sse2,detail::Scan_level::avx2}){
+		if(l>detail::scan_level()){continue;}
+		const double r = gbps(text.size(),[&](){
+			for(size_t i=0;i<text.size();i+=detail::scan_chunk){
+				sink += detail::find_structurals(text.data()+i,std::min(detail::scan_chunk,text.size()-i),index,l);
+			}
+		});
+		std::cout << "find_structurals " << level_name(l) << "\t" << r << " GB/s\n";
+	}
+
+	const double by_line = gbps(text.size(),[&](){
+		Count_handler h;
+		std::string_view t = text;
+		size_t line_num=0;
+		while(!t.empty()){
+			const detail::Line l = detail::parse_line(detail::next_line(t),"bench",++line_num);
+			switch(l.kind){
+				case detail::Line::Kind::empty       : break;
+				case detail::Line::Kind::value       : h.on_value(l.key,l.value); break;
+				case detail::Line::Kind::open_block  : h.on_open_block(l.key); break;
+				case detail::Line::Kind::close_block : h.on_close_block(); break;
+				case detail::Line::Kind::empty_block : h.on_empty_block(l.key); break;
+			}
+		}
+		sink += h.n;
+	});
+	std::cout << "events by line  \t" << by_line << " GB/s\n";
+
+	const double scanned = gbps(text.size(),[&](){
+		Count_handler h;
+		parse_events(text,h,"bench");
+		sink += h.n;
+	});
+	std::cout << "events scanned  \t" << scanned << " GB/s\n";
+
+	const double tree = gbps(text.size(),[&](){
+		std::istringstream in(text);
+		BConfig b(in,"bench");
+		sink += b.memory_usage().values;
+	});
+	std::cout << "BConfig parse   \t" << tree << " GB/s\t(" << sink%10 << ")\n";
+	return 0;
+}
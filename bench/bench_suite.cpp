@@ -0,0 +1,162 @@
+//============================================================================
+// Name        : bench_suite.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Baseline of the main BConfig operations on synthetic inputs (see bench_generator.hpp).
+// For each case : throughput, latency percentiles of one operation, and heap allocations per operation.
+// build : g++ -std=c++17 -O2 -pthread -I../src bench_suite.cpp ../src/BConfig.cpp ../src/BConfig_serialize.cpp ../src/helpers/*.cpp
+// usage : ./a.out [size_kb=1024] [filter=""]   filter : only the cases whose name contains it, e.g. "parse" or "repeated"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include "BConfig.hpp"
+#include "bench_generator.hpp"
+
+using namespace bconfig;
+using bench::Shape;
+
+
+//count the heap allocations of the whole program
+namespace{ std::atomic<size_t> allocations{0}; }
+
+void *operator new(size_t n){
+	allocations.fetch_add(1,std::memory_order_relaxed);
+	if(void *p = std::malloc(n==0 ? 1 : n)){return p;}
+	throw std::bad_alloc();
+}
+void  operator delete(void *p)noexcept        {std::free(p);}
+void  operator delete(void *p, size_t)noexcept{std::free(p);}
+
+
+
+namespace{
+
+	size_t sink=0; //keeps the results alive
+
+	struct Case{
+		std::string name;
+		size_t      bytes_per_op; //0 : no throughput in MB/s
+		size_t      batch;        //operations per timed sample
+	};
+
+	//run f samples*batch times, one timing per batch
+	template<typename F>
+	void run(const Case &c, const std::string &filter, size_t samples, F f){
+		if(c.name.find(filter)==std::string::npos){return;}
+
+		f(); //warm up
+		std::vector<double> ns;
+		ns.reserve(samples);
+		const size_t alloc0 = allocations.load();
+		const auto   t0     = std::chrono::steady_clock::now();
+		for(size_t s=0;s<samples;++s){
+			auto a = std::chrono::steady_clock::now();
+			for(size_t i=0;i<c.batch;++i){f();}
+			auto b = std::chrono::steady_clock::now();
+			ns.push_back(std::chrono::duration<double,std::nano>(b-a).count()/static_cast<double>(c.batch));
+		}
+		const double total_s = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+		const double ops     = static_cast<double>(samples*c.batch);
+		const double allocs  = static_cast<double>(allocations.load()-alloc0)/ops;
+
+		std::sort(ns.begin(),ns.end());
+		auto pct = [&](double p){return ns[std::min(ns.size()-1,static_cast<size_t>(p*static_cast<double>(ns.size())))];};
+
+		std::cout << std::left << std::setw(34) << c.name << std::right << std::fixed << std::setprecision(1)
+		          << std::setw(12) << ops/total_s << " op/s";
+		if(c.bytes_per_op){std::cout << std::setw(9) << static_cast<double>(c.bytes_per_op)*ops/total_s/1e6 << " MB/s";}
+		else              {std::cout << std::setw(14) << "";}
+		std::cout << "   p50 " << std::setw(10) << pct(0.5) << " ns  p90 " << std::setw(10) << pct(0.9)
+		          << " ns  p99 " << std::setw(10) << pct(0.99) << " ns   " << std::setprecision(2) << allocs << " alloc/op\n";
+	}
+
+	BConfig parse(const std::string &text){
+		std::istringstream in(text);
+		return BConfig(in,"bench");
+	}
+
+	//samples for operations that process the whole input
+	size_t whole_samples(const std::string &text){return std::max<size_t>(5,std::min<size_t>(50,(64u<<20)/text.size()));}
+
+}
+
+
+
+int main(int argc,char** argv) {
+	const size_t      size_kb = argc>1 ? std::strtoul(argv[1],nullptr,10) : 1024;
+	const std::string filter  = argc>2 ? argv[2] : "";
+	const size_t      bytes   = size_kb*1024;
+
+	const Shape shapes[] = {Shape::wide,Shape::deep,Shape::repeated,Shape::multi,Shape::numeric};
+	std::vector<std::string> text;
+	std::vector<BConfig>     tree;
+	for(Shape s : shapes){
+		text.push_back(bench::generate(s,bytes));
+		tree.push_back(parse(text.back()));
+	}
+	std::cout << "input " << size_kb << " KB per shape\n";
+
+	Serialize_options sorted;
+	sorted.order = Serialize_options::Order::sorted;
+	const int dev_null = ::open("/dev/null",O_WRONLY);
+
+	//whole input operations, every shape
+	for(size_t i=0;i<text.size();++i){
+		const std::string shape = bench::shape_name(shapes[i]);
+		const std::string &t    = text[i];
+		const BConfig     &b    = tree[i];
+		run({"parse/"+shape,t.size(),1},filter,whole_samples(t),[&](){sink += parse(t).count_values("x");});
+		run({"print/"+shape,t.size(),1},filter,whole_samples(t),[&](){std::ostringstream out; b.print(out); sink += out.tellp();});
+		run({"copy/" +shape,t.size(),1},filter,whole_samples(t),[&](){BConfig c(b); sink += c.count_blocks("x");});
+		run({"serialize/"+shape,t.size(),1},filter,whole_samples(t),[&](){sink += b.serialize().size();});
+		run({"serialize_sorted/"+shape,t.size(),1},filter,whole_samples(t),[&](){sink += b.serialize(sorted).size();});
+		run({"serialize_fd/"+shape,t.size(),1},filter,whole_samples(t),[&](){b.serialize(dev_null);});
+	}
+
+	const BConfig &wide     = tree[0];
+	const BConfig &deep     = tree[1];
+	const BConfig &repeated = tree[2];
+	const BConfig &multi    = tree[3];
+	const BConfig &numeric  = tree[4];
+
+	//lookups : keys are chosen with a fixed stride, the same for every run
+	std::vector<std::string> keys;
+	for(size_t i=0; wide.has_values("key_"+std::to_string(i)); i+=97){keys.push_back("key_"+std::to_string(i));}
+	size_t k=0;
+	run({"get_unique_value<string>/wide",0,1000},filter,200,[&](){sink += wide.get_unique_value<std::string>(keys[k++%keys.size()]).size();});
+	run({"get_value_view/wide",0,1000},filter,200,[&](){sink += wide.get_value_view(keys[k++%keys.size()]).size();});
+
+	std::vector<std::string> ints, floats;
+	for(size_t i=0; numeric.has_values("int_"+std::to_string(i)); i+=97){ints.push_back("int_"+std::to_string(i)); floats.push_back("float_"+std::to_string(i));}
+	run({"get_unique_value<int64>/numeric",0,1000},filter,200,[&](){sink += static_cast<size_t>(numeric.get_unique_value<long long>(ints[k++%ints.size()]));});
+	run({"get_unique_value<double>/numeric",0,1000},filter,200,[&](){sink += numeric.get_unique_value<double>(floats[k++%floats.size()])>0;});
+
+	const std::string lists[8] = {"list_0","list_1","list_2","list_3","list_4","list_5","list_6","list_7"};
+	run({"get_values<string>/multi",0,1},filter,50,[&](){sink += multi.get_values<std::string>(lists[k++%8]).size();});
+	run({"get_values_view/multi",0,1000},filter,200,[&](){sink += multi.get_values_view(lists[k++%8]).size();});
+
+	run({"get_blocks/repeated",0,1},filter,20,[&](){sink += repeated.get_blocks("item").size();});
+	run({"get_blocks_view/repeated",0,1},filter,200,[&](){for(const BConfig &c : repeated.get_blocks_view("item")){sink += c.count_values("id");}});
+	run({"get_yes_no/repeated",0,1},filter,50,[&](){for(const BConfig &c : repeated.get_blocks_view("item")){sink += c.get_yes_no("enabled");}});
+
+	run({"get_unique_block_ref/deep",0,100},filter,200,[&](){
+		const BConfig *c = &deep.get_blocks_view("level")[0];
+		while(c->has_values("depth") and c->count_blocks("level")==1){c = &c->get_unique_block_ref("level");}
+		sink += c->get_unique_value<size_t>("depth");
+	});
+
+	if(sink==1){std::cout << sink;}
+	return 0;
+}
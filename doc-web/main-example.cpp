@@ -8,6 +8,8 @@
 #include <iostream>
 #include "BConfig.hpp"
 
+using namespace bconfig;
+
 
 int main(int ,char**) {
 
@@ -50,20 +52,20 @@ int main(int ,char**) {
 		}
 	*/
 
-	std::deque<BConfig> all_trees = forest.get_blocks("tree",false);
+	BConfig::Block_range all_trees = forest.get_blocks_view("tree",false);
 	//tree is the block name
 	//false means do not trow exception if there is no tree (i.e., the forest can be empty)
+	//get_blocks_view gives references on the blocks of forest, use get_blocks to get copies.
 
 	for(const BConfig & tree : all_trees){
 		std::cout <<"---Tree : " <<tree.get_unique_value("name")<<"---\n";
-		const BConfig &trunk = tree.get_unique_block("trunk");//one single trunk per tree.
+		const BConfig &trunk = tree.get_unique_block_ref("trunk");//one single trunk per tree.
 
 		std::cout <<"trunk_size : "<<trunk.get_unique_value<size_t>("size") << "\n";
 		std::cout <<"trunk_type : "<<trunk.get_unique_value("type") << "\n"; //default : get std::string
 
 		//for each branch
-		const std::deque<BConfig> & all_branch = tree.get_blocks("branch",false);
-		for(const BConfig & branch : all_branch){
+		for(const BConfig & branch : tree.get_blocks_view("branch",false)){
 
 			//check if the branch is broken
 			bool broken = branch.get_yes_no("broken",false); //false = default : not_broken
@@ -71,8 +73,7 @@ int main(int ,char**) {
 			std::cout << "-alive_branch-\n";
 
 			//if the branch is not broken : read leaves
-			const std::deque<BConfig> & all_leaves = branch.get_blocks("leave",false);
-			for(const BConfig & leave : all_leaves){
+			for(const BConfig & leave : branch.get_blocks_view("leave",false)){
 				std::cout << "leave_color : " << leave.get_unique_value<std::string>("color","green")<<"\n";//default color is green
 			}
 		}
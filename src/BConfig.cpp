@@ -6,57 +6,150 @@
 
 
 #include "BConfig.hpp"
+#include "BConfig_events.hpp"
 #include "helpers/OpenFile.h"
+#include "helpers/MappedFile.h"
+#include "helpers/CompressedFile.h"
 #include "helpers/str_tools.h"
+#include "helpers/str_convert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <map>
+#include <thread>
+#include <tuple>
+
+#include <cerrno>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BCONFIG_POSIX_FILES
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#endif
+
+#if defined(__SSE2__) || (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)))
+#include <immintrin.h>
+#endif
 
 
 using namespace bconfig;
 
 
 
-const std::deque<BConfig> BConfig::get_blocks(const std::string &key, bool throw_b)const{
-	//auto f = blocks.find(key);
-	std::deque<BConfig> R;
+const std::vector<uint32_t> *BConfig::find_blocks(Key key)const{
+	BCONFIG_COUNT(block_lookups,1);
+	const auto &index = body().block_index;
+	auto f = index.find(key);
+	if(f==index.end()){return nullptr;}
+	return &f->second;
+}
 
-	for(const auto &p : blocks){
-		if(p.first==key){
-			R.push_back(p.second);
-		}
+
+
+BConfig &BConfig::add_block(Key key){
+	block_index[key].push_back(static_cast<uint32_t>(blocks.size()));
+	blocks.emplace_back(key.name,BConfig());
+	BConfig &R = blocks.back().second;
+	R.storage  = storage;
+	return R;
+}
+
+
+
+std::deque<BConfig> BConfig::get_blocks(Key key, bool throw_b)const &{
+	Block_range d = get_blocks_view(key,throw_b);
+	return std::deque<BConfig>(d.begin(),d.end());
+}
+
+
+
+std::deque<BConfig> BConfig::get_blocks(Key key, bool throw_b)&&{
+	if(lazy.use_count()>1){return get_blocks(key,throw_b);} //shared content : copy
+	own_body();
+
+	std::deque<BConfig> R;
+	const std::vector<uint32_t> *f = find_blocks(key);
+	if(f==nullptr){
+		if(throw_b){throw Error_BConfig_get("Missing block", key);}
+		return R;
 	}
+	BCONFIG_COUNT(blocks_visited,f->size());
+	for(uint32_t i : *f){R.push_back(std::move(blocks[i].second));}
+	return R;
+}
+
 
-	if(R.size()==0 and throw_b)	{throw Error_BConfig_get("Missing block", key);}
-	else return R;
+
+BConfig BConfig::get_unique_block(Key key)const &{
+	return get_unique_block_ref(key);
 }
 
 
 
-const BConfig BConfig::get_unique_block(const std::string &key)const{
-	const auto &d= get_blocks(key,true);
+BConfig BConfig::get_unique_block(Key key)&&{
+	if(lazy.use_count()>1){return get_unique_block_ref(key);} //shared content : copy
+	own_body();
+
+	const std::vector<uint32_t> *f = find_blocks(key);
+	if(f==nullptr){throw Error_BConfig_get("Missing block", key);}
+	BCONFIG_COUNT(blocks_visited,f->size());
+	if(f->size()!=1){throw Error_BConfig_get("Multiple blocks", key);}
+	return std::move(blocks[f->front()].second);
+}
+
+
+
+BConfig::Block_range BConfig::get_blocks_view(Key key, bool throw_b)const{
+	const std::vector<uint32_t> *f = find_blocks(key);
+	if(f==nullptr){
+		if(throw_b){throw Error_BConfig_get("Missing block", key);}
+		return Block_range();
+	}
+	BCONFIG_COUNT(blocks_visited,f->size());
+	return Block_range(body().blocks,*f);
+}
+
+
+
+const BConfig &BConfig::get_unique_block_ref(Key key)const{
+	Block_range d = get_blocks_view(key,true);
 	if(d.size()!=1){throw Error_BConfig_get("Multiple blocks", key);}
 	return d[0];
 }
 
 
 
-size_t BConfig::count_blocks(const std::string &key)const{
-	size_t count=0;
-	for(const auto &p : blocks){
-		if(p.first==key){++count;}
-	}
-	return count;
+size_t BConfig::count_blocks(Key key)const{
+	const std::vector<uint32_t> *f = find_blocks(key);
+	return f==nullptr ? 0 : f->size();
 }
 
 
-bool BConfig::get_yes_no(const std::string &key)const{
-	std::string s=get_unique_value<std::string>(key);
+bool BConfig::get_yes_no(Key key)const{
+	const detail::Value_list &d = get_unique_list(key);
+	if(!d.decoded.empty() and d.decoded[0].kind==detail::Decoded::Kind::yes_no){return d.decoded[0].yes_no;}
+	std::string_view s=d.text[0];
 	if(s=="y" or s== "yes"){return true;}
 	if(s=="n" or s== "no"){return false;}
 	throw Error_BConfig_get("get_yes_no : invalid string", key,s);
 }
 
 
-bool BConfig::get_yes_no(const std::string &key,bool default_v)const{
-	std::string s=get_unique_value<std::string>(key,"");
+bool BConfig::get_yes_no(Key key,bool default_v)const{
+	const detail::Value_list *d = find_values(key);
+	if(d==nullptr){return default_v;}
+	if(d->text.size()!=1){throw_multiple_values(key,d->text);}
+	if(!d->decoded.empty() and d->decoded[0].kind==detail::Decoded::Kind::yes_no){return d->decoded[0].yes_no;}
+	std::string_view s=d->text[0];
 	if(s=="")return default_v;
 	if(s=="y" or s== "yes"){return true;}
 	if(s=="n" or s== "no"){return false;}
@@ -66,120 +159,1269 @@ bool BConfig::get_yes_no(const std::string &key,bool default_v)const{
 
 
 
-void BConfig::parse(std::istream &in, const std::string &path){
-	using namespace bconfig;
-	using namespace str;
+void BConfig::throw_multiple_values(std::string_view key, const std::deque<std::string_view> &d){
+	std::string vvv;
+	for(std::string_view i : d){vvv +=" "; vvv+=i;}
+	throw Error_BConfig_get("Multiple values",key,vvv);
+}
 
-	enum struct Mode{undefined,value,open_blockk, close_blockk,comment,empty_blockk};
-	Mode mode=Mode::undefined;
 
 
-	std::string l;
+detail::Decoded detail::Decoded::decode(std::string_view s){
+	Decoded R;
+	if(str::fromChars(s,R.integer )){R.kind=Kind::integer ;return R;}
+	if(str::fromChars(s,R.floating)){R.kind=Kind::floating;return R;}
+	if(s=="y" or s=="yes"){R.kind=Kind::yes_no;R.yes_no=true ;return R;}
+	if(s=="n" or s=="no" ){R.kind=Kind::yes_no;R.yes_no=false;return R;}
+	R.integer=0;
+	return R;
+}
 
 
-	size_t line_num=0;
-	while(getline(in,l)){
-		++line_num;
-		str::trim(l," \t");
-		if(l=="")continue;
 
-		mode=Mode::undefined;
+void BConfig::add_value(Key key, std::string_view value, bool decode){
+	detail::Value_list &d = values[key];
+	d.text.push_back(value);
+
+	//keep decoded parallel to text once a value of this key is decoded
+	if(decode or !d.decoded.empty()){
+		while(d.decoded.size()<d.text.size()){d.decoded.push_back(detail::Decoded::decode(d.text[d.decoded.size()]));}
+	}
+}
+
+
 
-		std::string current_id="";
-		std::string current_value="";
+namespace bconfig{ namespace detail{
+	//events to BConfig tree, see BConfig_events.hpp
+	struct Tree_builder{
+		std::vector<BConfig*> stack; //stack.back() receives the events
+		bool decode;
+		const std::string   *path       =nullptr; //the parsed file, for include directives
+		const Parse_options *include_opt=nullptr; //not null : Parse_options::include
 
-		for(char c : l){
-			if(c=='#'){
-				if(mode==Mode::undefined){mode=Mode::comment;}
-				goto do_line;
+		void set_options(const std::string &path_, const Parse_options &opt){
+			decode = opt.decode_values;
+			if(opt.include){path=&path_; include_opt=&opt;}
+		}
+
+		void on_value(std::string_view key, std::string_view value){
+			if(include_opt!=nullptr and key=="include"){stack.back()->include(value,*path,*include_opt); return;}
+			stack.back()->add_value(key,value,decode);
+		}
+		void on_open_block (std::string_view key){stack.push_back(&stack.back()->add_block(key));}
+		void on_close_block()                    {stack.pop_back();}
+		void on_empty_block(std::string_view key){stack.back()->add_block(key);}
+	};
+
+#ifdef BCONFIG_COUNTERS
+	//a Tree_builder that fills Parse_stats, see Parse_options::stats
+	struct Counting_tree_builder: Tree_builder{
+		typedef std::chrono::steady_clock clock;
+		Parse_stats &stats;
+
+		explicit Counting_tree_builder(Parse_stats &stats_):stats(stats_){}
+
+		void on_value(std::string_view key, std::string_view value){
+			const auto t0 = clock::now();
+			Tree_builder::on_value(key,value);
+			++stats.values;
+			stats.build_time += clock::now()-t0;
+		}
+		void on_open_block(std::string_view key){
+			const auto t0 = clock::now();
+			Tree_builder::on_open_block(key);
+			++stats.nodes;
+			stats.max_depth   = std::max(stats.max_depth,stack.size()-1);
+			stats.build_time += clock::now()-t0;
+		}
+		void on_close_block(){
+			const auto t0 = clock::now();
+			Tree_builder::on_close_block();
+			stats.build_time += clock::now()-t0;
+		}
+		void on_empty_block(std::string_view key){
+			const auto t0 = clock::now();
+			Tree_builder::on_empty_block(key);
+			++stats.nodes;
+			stats.max_depth   = std::max(stats.max_depth,stack.size());
+			stats.build_time += clock::now()-t0;
+		}
+	};
+#endif
+}}
+
+
+
+#ifdef BCONFIG_COUNTERS
+namespace{
+	size_t count_lines(std::string_view text){
+		return static_cast<size_t>(std::count(text.begin(),text.end(),'\n')) + (!text.empty() and text.back()!='\n');
+	}
+
+	void add_stats(Parse_stats &a, const Parse_stats &b){
+		a.nodes         += b.nodes;
+		a.values        += b.values;
+		a.max_depth      = std::max(a.max_depth,b.max_depth);
+		a.tokenize_time += b.tokenize_time;
+		a.build_time    += b.build_time;
+	}
+
+	//fills Parse_options::stats and calls the parse hook, for one BConfig::parse
+	struct Parse_recorder{
+		typedef std::chrono::steady_clock clock;
+		Parse_options opt; //the options to parse with, stats points to R when recording
+		Parse_stats   R;
+		clock::time_point t0;
+
+		explicit Parse_recorder(const Parse_options &opt_):opt(opt_){
+			detail::Parse_hook_storage &h = detail::parse_hook_storage();
+			std::lock_guard<std::mutex> lock(h.m);
+			if(opt.stats==nullptr and !h.f){return;}
+			opt.stats = &R;
+			t0        = clock::now();
+		}
+
+		void loaded(std::string_view text){
+			if(opt.stats==nullptr){return;}
+			R.io_time = clock::now()-t0;
+			R.bytes   = text.size();
+			R.lines   = count_lines(text);
+		}
+
+		void done(const std::string &path, const Parse_options &user_opt){
+			if(opt.stats==nullptr){return;}
+			if(user_opt.stats!=nullptr){*user_opt.stats = R;}
+			parse_hook_t f;
+			{
+				detail::Parse_hook_storage &h = detail::parse_hook_storage();
+				std::lock_guard<std::mutex> lock(h.m);
+				f = h.f;
 			}
+			if(f){f(path,R);} //outside of the lock : the hook may parse, or set the hook
+		}
+	};
+}
+#endif
+
+
+namespace bconfig{ namespace detail{
+	//a version of a file, to know whether a parse of it is still valid
+	struct File_version{
+#ifdef BCONFIG_POSIX_FILES
+		typedef std::pair<uint64_t,uint64_t> Id; //device, inode
+#else
+		typedef std::string Id; //canonical path
+#endif
+		std::string path;
+		Id          id{};
+		int64_t     mtime=0; //nanoseconds (POSIX), file clock ticks otherwise
+		uint64_t    size =0;
+
+		//false if path cannot be read
+		bool read(const std::string &path_){
+#ifdef BCONFIG_POSIX_FILES
+			struct stat st;
+			if(::stat(path_.c_str(),&st)!=0){return false;}
+#ifdef __APPLE__
+			const struct timespec &t = st.st_mtimespec;
+#else
+			const struct timespec &t = st.st_mtim;
+#endif
+			id    = Id(static_cast<uint64_t>(st.st_dev),static_cast<uint64_t>(st.st_ino));
+			mtime = static_cast<int64_t>(t.tv_sec)*1000000000+t.tv_nsec;
+			size  = static_cast<uint64_t>(st.st_size);
+#else
+			std::error_code e;
+			const std::filesystem::path p = std::filesystem::canonical(path_,e);
+			if(e){return false;}
+			const auto t = std::filesystem::last_write_time(p,e);
+			if(e){return false;}
+			const uintmax_t n = std::filesystem::file_size(p,e);
+			if(e){return false;}
+			id    = p.string();
+			mtime = static_cast<int64_t>(t.time_since_epoch().count());
+			size  = static_cast<uint64_t>(n);
+#endif
+			path = path_;
+			return true;
+		}
+
+		bool same_file(const File_version &v)const{return id==v.id;}
+		bool unchanged()const{File_version v; return v.read(path) and same_file(v) and mtime==v.mtime and size==v.size;}
+	};
+
+	//the files included while a file is parsed (directly or not), lazy blocks may add some after the parse
+	struct Include_depends{
+		std::mutex                m;
+		std::vector<File_version> files;
+
+		void add(const File_version &v, const std::vector<File_version> &v_depends){
+			std::lock_guard<std::mutex> lock(m);
+			files.push_back(v);
+			files.insert(files.end(),v_depends.begin(),v_depends.end());
+		}
+
+		std::vector<File_version> get(){
+			std::lock_guard<std::mutex> lock(m);
+			return files;
+		}
+	};
+
+	//the files being parsed with Parse_options::include, innermost first
+	struct Include_chain{
+		File_version                           file;
+		std::shared_ptr<Include_depends>       depends;
+		std::shared_ptr<const Include_chain>   parent;
+	};
+}}
+
 
-			if(mode==Mode::undefined){
-				if(c=='='){mode=Mode::value      ;continue;}
-				if(c=='{'){mode=Mode::open_blockk ;continue;}
-				if(c=='}'){mode=Mode::close_blockk;continue;}
-				current_id+=c;
+namespace{
+	//the include chain of the parse running on this thread, empty outside of parses with Parse_options::include
+	thread_local std::shared_ptr<const detail::Include_chain> include_chain;
+
+	//set the include chain of this thread until destruction
+	struct Include_scope{
+		std::shared_ptr<const detail::Include_chain> previous;
+		explicit Include_scope(std::shared_ptr<const detail::Include_chain> c):previous(std::move(include_chain)){include_chain=std::move(c);}
+		~Include_scope(){include_chain=std::move(previous);}
+		Include_scope(const Include_scope &)=delete;
+		Include_scope &operator=(const Include_scope &)=delete;
+	};
+
+	//the include chain of a parse of the file located at path : the chain of this thread, with path inside if it is the outermost file
+	std::shared_ptr<const detail::Include_chain> include_chain_of(const std::string &path, const Parse_options &opt){
+		if(!opt.include or include_chain!=nullptr){return include_chain;} //not an include, or already pushed by Include_cache::load
+		auto R = std::make_shared<detail::Include_chain>();
+		R->file.read(path);
+		R->depends = std::make_shared<detail::Include_depends>();
+		return R;
+	}
+}
+
+
+namespace bconfig{ namespace detail{
+	//a block parsed on first access, see Parse_options::lazy
+	struct Lazy_block{
+		std::string_view                   text;     //lines of the block, up to its closing line
+		size_t                             line_num; //lines before text
+		std::shared_ptr<const std::string> path;
+		Parse_options                      opt;
+		std::shared_ptr<Text_storage>      storage;
+		std::shared_ptr<const Include_chain> includes; //the include chain of the parse that skipped the block
+		std::mutex                         m;
+		std::atomic<bool>                  parsed{false};
+		BConfig                            tree;
+
+		const BConfig &get(){
+			if(parsed.load(std::memory_order_acquire)){return tree;}
+
+			//not std::call_once : it must stay usable when the parse throws, the next access throws again
+			std::lock_guard<std::mutex> lock(m);
+			if(!parsed.load(std::memory_order_relaxed)){
+				Include_scope scope(includes);
+				BConfig b;
+				b.storage = storage;
+				b.parse_lazy(text,path,line_num,opt);
+				tree = std::move(b);
+				parsed.store(true,std::memory_order_release);
 			}
+			return tree;
+		}
+	};
+}}
 
-			if(mode==Mode::value)      {current_value +=c;}
 
-			if(mode==Mode::open_blockk) {
-				if(c == ' ' or c == '\t'){ continue;}
-				if(c=='}'){mode=Mode::empty_blockk;continue;}
-				throw Error_BConfig_parse("open_blockk" ,path,line_num);
+const BConfig &BConfig::lazy_body()const{
+	return lazy->get();
+}
+
+
+
+void BConfig::own_body(){
+	if(lazy==nullptr){return;}
+	lazy->get();
+	//b holds the content while *this releases the lazy block
+	BConfig b = lazy.use_count()==1 ? std::move(lazy->tree) : BConfig(lazy->tree);
+	*this = std::move(b);
+}
+
+
+
+namespace bconfig{ namespace detail{
+	//the files parsed for include directives, shared by the whole process, see Parse_options::include
+	struct Include_cache{
+		struct Entry{
+			File_version                     version;
+			std::shared_ptr<Include_depends> depends;
+			std::shared_ptr<const BConfig>   tree;
+		};
+
+		static Include_cache &get(){static Include_cache R; return R;}
+
+		//the tree of the file located at path, included from the file from. The tree is parsed, or taken from the cache if no file it was parsed from changed.
+		std::shared_ptr<const BConfig> load(const std::string &path, const std::string &from, const Parse_options &opt){
+			File_version v;
+			if(!v.read(path)){throw Error_BConfig_parse("include : cannot open "+path,from);}
+
+			for(const Include_chain *c = include_chain.get(); c!=nullptr; c=c->parent.get()){
+				if(!c->file.same_file(v)){continue;}
+				std::string cycle = path;
+				for(const Include_chain *d = include_chain.get(); ; d=d->parent.get()){
+					cycle = d->file.path+" -> "+cycle;
+					if(d==c){break;}
+				}
+				throw Error_BConfig_parse("include cycle : "+cycle,from);
 			}
 
-			if(mode==Mode::close_blockk){
-				if(c == ' ' or c == '\t'){ continue;}
-				throw Error_BConfig_parse("close_blockk",path,line_num);
+			const auto key = std::make_tuple(v.id,opt.decode_values,opt.lazy);
+			{
+				std::unique_lock<std::mutex> lock(m);
+				auto f = entries.find(key);
+				if(f!=entries.end() and f->second.version.mtime==v.mtime and f->second.version.size==v.size){
+					Entry e = f->second;
+					lock.unlock();
+					std::vector<File_version> depends = e.depends->get();
+					bool valid = true;
+					for(const File_version &d : depends){if(!d.unchanged()){valid=false; break;}}
+					if(valid){
+						if(include_chain){include_chain->depends->add(v,depends);}
+						return e.tree;
+					}
+				}
 			}
 
-			if(mode==Mode::empty_blockk){
-				if(c == ' ' or c == '\t'){ continue;}
-				throw Error_BConfig_parse("empty_blockk",path,line_num);
+			//parse the file, with the file inside the include chain
+			auto chain = std::make_shared<Include_chain>();
+			chain->file    = v;
+			chain->depends = std::make_shared<Include_depends>();
+			chain->parent  = include_chain;
+
+			//read, never mapped : the cached tree is shared and long lived, a mapping would change under it when the file is rewritten in place
+			Parse_options o = opt;
+			o.mmap  = false;
+			o.stats = nullptr;
+			BConfig b;
+			try{
+				Include_scope scope(chain);
+				b.parse(path,o);
+			}catch(Error_BConfig_parse &e){
+				e.included_from(from);
+				throw;
 			}
-		}//end for char
 
-		do_line:
+			//blocks become immutable subtrees, copies share them
+			auto shared_path = std::make_shared<const std::string>(path);
+			for(auto &kb : b.blocks){
+				if(kb.second.lazy){continue;}
+				auto l = std::make_shared<Lazy_block>();
+				l->path    = shared_path;
+				l->opt     = o;
+				l->storage = b.storage;
+				l->tree    = std::move(kb.second);
+				l->parsed.store(true,std::memory_order_release);
+				kb.second         = BConfig();
+				kb.second.storage = b.storage;
+				kb.second.lazy    = std::move(l);
+			}
 
-		if(mode==Mode::comment){continue;} //full line is a comment
-		trim(current_value," \t");
-		trim(current_id," \t");
+			Entry e;
+			e.version = v;
+			e.depends = chain->depends;
+			e.tree    = std::make_shared<const BConfig>(std::move(b));
+			if(include_chain){include_chain->depends->add(v,e.depends->get());}
+
+			std::lock_guard<std::mutex> lock(m);
+			entries[key] = e;
+			return e.tree;
+		}
 
-		if(mode==Mode::value){
-			values[current_id].push_back(current_value);
-			continue;
+		void clear(){
+			std::lock_guard<std::mutex> lock(m);
+			entries.clear();
 		}
 
-		if(mode==Mode::open_blockk){
-			BConfig new_block;
+	private:
+		std::mutex m;
+		std::map<std::tuple<File_version::Id,bool,bool>, Entry> entries; //file, Parse_options::decode_values, Parse_options::lazy
+	};
+}}
+
+
+
+void bconfig::clear_include_cache(){
+	detail::Include_cache::get().clear();
+}
+
+
+
+void BConfig::include(std::string_view path, const std::string &from, const Parse_options &opt){
+	std::string p(path);
+	const size_t slash = from.rfind('/');
+	if(!p.empty() and p[0]!='/' and slash!=std::string::npos){p = from.substr(0,slash+1)+p;}
+
+	std::shared_ptr<const BConfig> tree = detail::Include_cache::get().load(p,from,opt);
+	if(tree->storage){storage->add_once(tree,tree->storage->texts());}
+	BConfig b(*tree);
+	append(std::move(b));
+}
+
+
+#ifdef BCONFIG_COUNTERS
+//lazy parse : count a top-level line, depth is 1 for a block
+#define BCONFIG_PARSE_COUNT(counter,depth) if(opt.stats!=nullptr){++opt.stats->counter; opt.stats->max_depth=std::max<size_t>(opt.stats->max_depth,depth);}
+#else
+#define BCONFIG_PARSE_COUNT(counter,depth)
+#endif
+
+void BConfig::parse_lazy(std::string_view text, const std::shared_ptr<const std::string> &path, size_t line_num, const Parse_options &opt){
+	while(!text.empty()){
+		std::string_view l = detail::next_line(text);
+		++line_num;
 
-			//blocks[current_id].push_back(new_block);
-			key_block_t k;
-			k.first = current_id;
-			k.second.parse(in,path);
-			blocks.push_back(k);
-			continue;
+		const detail::Line line = detail::parse_line(l,*path,line_num);
+		switch(line.kind){
+			case detail::Line::Kind::empty       : break;
+			case detail::Line::Kind::value       :
+				if(opt.include and line.key=="include"){include(line.value,*path,opt); break;}
+				add_value(line.key,line.value,opt.decode_values);
+				BCONFIG_PARSE_COUNT(values,0);
+				break;
+			case detail::Line::Kind::empty_block : add_block(line.key); BCONFIG_PARSE_COUNT(nodes,1); break;
+			case detail::Line::Kind::close_block : return;
+			case detail::Line::Kind::open_block  : {
+				auto l = std::make_shared<detail::Lazy_block>();
+				l->line_num = line_num;
+				l->text     = detail::skip_block(text,line_num);
+				l->path     = path;
+				l->opt      = opt;
+				l->opt.stats= nullptr; //the stats of this parse are gone when the block is parsed
+				l->storage  = storage;
+				l->includes = include_chain;
+				add_block(line.key).lazy = std::move(l);
+				BCONFIG_PARSE_COUNT(nodes,1);
+				break;
+			}
 		}
+	}
+}
+
+
+void BConfig::parse_lines(std::string_view text, const std::string &path, size_t line_num, const Parse_options &opt){
+#ifdef BCONFIG_COUNTERS
+	if(opt.stats!=nullptr){
+		detail::Counting_tree_builder h(*opt.stats);
+		h.stack.push_back(this);
+		h.set_options(path,opt);
+		const auto t0     = std::chrono::steady_clock::now();
+		const auto build0 = opt.stats->build_time;
+		parse_events(text,h,path,line_num);
+		opt.stats->tokenize_time += std::chrono::steady_clock::now()-t0-(opt.stats->build_time-build0);
+		return;
+	}
+#endif
+
+	detail::Tree_builder h;
+	h.stack.push_back(this);
+	h.set_options(path,opt);
+	parse_events(text,h,path,line_num);
+}
+
 
-		if(mode==Mode::empty_blockk){
-			key_block_t k;
-			k.first = current_id;
-			blocks.push_back(k);
-			continue;
+namespace{
+	//smallest piece of input parsed by a thread, smaller inputs are parsed sequentially
+	const size_t parallel_min_chunk = 1<<18;
+
+	//a piece of the input for BConfig::parse_parallel : whole lines, starting at top-level
+	struct Chunk{
+		std::string_view text;
+		size_t           line_num; //number of lines before text
+	};
+
+	//cut text in chunks of about target bytes, only between top-level lines
+	std::vector<Chunk> split_top_level(std::string_view text, size_t target){
+		std::vector<Chunk> R;
+		size_t depth=0, line_num=0;
+		size_t chunk_begin=0, chunk_line=0;
+		size_t pos=0;
+
+		while(pos<text.size()){
+			if(depth==0 and pos-chunk_begin>=target){
+				R.push_back(Chunk{text.substr(chunk_begin,pos-chunk_begin),chunk_line});
+				chunk_begin = pos;
+				chunk_line  = line_num;
+			}
+
+			size_t eol = text.find('\n',pos);
+			size_t end = eol==std::string_view::npos ? text.size() : eol+1;
+			int d = detail::line_depth_change(text.substr(pos,end-pos));
+			pos = end;
+			++line_num;
+
+			if(d>0){++depth;}
+			if(d<0){
+				if(depth==0){break;} //a top-level } ends the parse, the rest of the text is ignored
+				--depth;
+			}
 		}
 
+		R.push_back(Chunk{text.substr(chunk_begin,pos-chunk_begin),chunk_line});
+		return R;
+	}
+}
+
+
 
-		if(mode==Mode::close_blockk){
-			return;
+void BConfig::append(BConfig &&b){
+	for(auto &v : b.values){
+		auto f = values.find(v.first);
+		if(f==values.end()){values.emplace(v.first,std::move(v.second)); continue;} //new key : take the whole list
+		detail::Value_list &d = f->second;
+		detail::Value_list &s = v.second;
+		const bool decoded = !d.decoded.empty() or !s.decoded.empty();
+		if(decoded){
+			while(d.decoded.size()<d.text.size()){d.decoded.push_back(detail::Decoded::decode(d.text[d.decoded.size()]));}
+			if(s.decoded.empty()){for(std::string_view t : s.text){d.decoded.push_back(detail::Decoded::decode(t));}}
+			else{d.decoded.insert(d.decoded.end(),s.decoded.begin(),s.decoded.end());}
 		}
+		d.text.insert(d.text.end(),s.text.begin(),s.text.end());
+	}
+
+	for(auto &kb : b.blocks){
+		block_index[kb.first].push_back(static_cast<uint32_t>(blocks.size()));
+		blocks.emplace_back(kb.first,std::move(kb.second));
+	}
+}
+
 
-		if(mode==Mode::undefined){
-			throw Error_BConfig_parse("undefined" ,path,line_num);
+
+void BConfig::parse_parallel(std::string_view text, const std::string &path, const Parse_options &opt){
+	const unsigned threads = opt.threads!=0 ? opt.threads : std::max(1u,std::thread::hardware_concurrency());
+	const std::vector<Chunk> chunks = split_top_level(text, std::max(parallel_min_chunk, text.size()/(size_t(threads)*4)));
+
+	std::vector<BConfig>            parsed(chunks.size());
+	std::vector<std::exception_ptr> errors(chunks.size());
+	std::atomic<size_t> next(0);
+	std::atomic<size_t> first_error(chunks.size()); //chunks after an error are not parsed
+
+#ifdef BCONFIG_COUNTERS
+	//each chunk has its own stats, added in order
+	std::vector<Parse_stats> stats(opt.stats!=nullptr ? chunks.size() : 0);
+#endif
+
+	const std::shared_ptr<const detail::Include_chain> chain = include_chain;
+	auto work = [&](){
+		Include_scope scope(chain);
+		for(size_t i=next++; i<chunks.size(); i=next++){
+			if(i>first_error.load()){continue;}
+			BConfig &b = parsed[i];
+			b.storage  = storage;
+			Parse_options chunk_opt = opt;
+#ifdef BCONFIG_COUNTERS
+			if(!stats.empty()){chunk_opt.stats = &stats[i];}
+#endif
+			try{
+				b.parse_lines(chunks[i].text,path,chunks[i].line_num,chunk_opt);
+			}catch(...){
+				errors[i] = std::current_exception();
+				size_t e = first_error.load();
+				while(i<e and !first_error.compare_exchange_weak(e,i)){}
+			}
 		}
+	};
+
+	std::vector<std::thread> pool;
+	const size_t pool_size = std::min<size_t>(threads,chunks.size())-1;
+	for(size_t i=0; i<pool_size; ++i){pool.emplace_back(work);}
+	work();
+	for(std::thread &t : pool){t.join();}
+
+	//stitch in input order, stop at the first error as a sequential parse does
+	for(size_t i=0; i<chunks.size(); ++i){
+		if(errors[i]){std::rethrow_exception(errors[i]);}
+		append(std::move(parsed[i]));
+#ifdef BCONFIG_COUNTERS
+		if(!stats.empty()){add_stats(*opt.stats,stats[i]);}
+#endif
+	}
+}
 
 
 
+void BConfig::parse_text(std::string_view text, std::shared_ptr<const void> owner, const std::string &path, const Parse_options &opt){
+	if(storage==nullptr){storage = std::make_shared<detail::Text_storage>();}
+	storage->add(std::move(owner),text);
 
+	own_body(); //parse appends : parse the content first
+
+	if(opt.lazy){
+#ifdef BCONFIG_COUNTERS
+		const auto t0 = std::chrono::steady_clock::now();
+		parse_lazy(text,std::make_shared<const std::string>(path),0,opt);
+		if(opt.stats!=nullptr){opt.stats->tokenize_time += std::chrono::steady_clock::now()-t0;}
+#else
+		parse_lazy(text,std::make_shared<const std::string>(path),0,opt);
+#endif
+		return;
+	}
+
+	if(opt.threads!=1 and text.size()>=2*parallel_min_chunk){
+		parse_parallel(text,path,opt);
+		return;
 	}
+
+	parse_lines(text,path,0,opt);
 }
 
 
-void BConfig::parse(const std::string & path){
+//structural scanner : one bit per byte of a 64 bytes block, set for the structural characters, then one offset per set bit
+namespace{
+	bool is_structural(char c){return c=='\n' or c=='=' or c=='{' or c=='}' or c=='#';}
+
+	size_t write_offsets(uint64_t mask, size_t base, uint16_t *out){
+		size_t R=0;
+		while(mask!=0){
+			out[R++] = static_cast<uint16_t>(base+static_cast<size_t>(__builtin_ctzll(mask)));
+			mask &= mask-1;
+		}
+		return R;
+	}
+
+	size_t find_structurals_scalar(const char *text, size_t begin, size_t n, uint16_t *out){
+		size_t R=0;
+		for(size_t i=begin; i<n; ++i){
+			if(is_structural(text[i])){out[R++]=static_cast<uint16_t>(i);}
+		}
+		return R;
+	}
+
+#if defined(__SSE2__)
+	#define BCONFIG_SCAN_SSE2
+	size_t find_structurals_sse2(const char *text, size_t n, uint16_t *out){
+		const __m128i eol=_mm_set1_epi8('\n'), eq=_mm_set1_epi8('='), open=_mm_set1_epi8('{'), close=_mm_set1_epi8('}'), hash=_mm_set1_epi8('#');
+		size_t R=0, i=0;
+		for(; i+64<=n; i+=64){
+			uint64_t mask=0;
+			for(size_t j=0; j<64; j+=16){
+				const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text+i+j));
+				const __m128i m = _mm_or_si128(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c,eol),_mm_cmpeq_epi8(c,eq)),_mm_or_si128(_mm_cmpeq_epi8(c,open),_mm_cmpeq_epi8(c,close))),_mm_cmpeq_epi8(c,hash));
+				mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(m)))<<j;
+			}
+			R += write_offsets(mask,i,out+R);
+		}
+		return R+find_structurals_scalar(text,i,n,out+R);
+	}
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define BCONFIG_SCAN_AVX2
+	__attribute__((target("avx2"))) size_t find_structurals_avx2(const char *text, size_t n, uint16_t *out){
+		const __m256i eol=_mm256_set1_epi8('\n'), eq=_mm256_set1_epi8('='), open=_mm256_set1_epi8('{'), close=_mm256_set1_epi8('}'), hash=_mm256_set1_epi8('#');
+		size_t R=0, i=0;
+		for(; i+64<=n; i+=64){
+			uint64_t mask=0;
+			for(size_t j=0; j<64; j+=32){
+				const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text+i+j));
+				const __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c,eol),_mm256_cmpeq_epi8(c,eq)),_mm256_or_si256(_mm256_cmpeq_epi8(c,open),_mm256_cmpeq_epi8(c,close))),_mm256_cmpeq_epi8(c,hash));
+				mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m)))<<j;
+			}
+			R += write_offsets(mask,i,out+R);
+		}
+		return R+find_structurals_scalar(text,i,n,out+R);
+	}
+#endif
+
+	detail::Scan_level best_scan_level(){
+#ifdef BCONFIG_SCAN_AVX2
+		if(__builtin_cpu_supports("avx2")){return detail::Scan_level::avx2;}
+#endif
+#ifdef BCONFIG_SCAN_SSE2
+		return detail::Scan_level::sse2;
+#else
+		return detail::Scan_level::scalar;
+#endif
+	}
+}
+
+
+detail::Scan_level detail::scan_level(){
+	static const Scan_level R = best_scan_level();
+	return R;
+}
+
+
+size_t detail::find_structurals(const char *text, size_t n, uint16_t *out, Scan_level level){
+	switch(std::min(level,scan_level())){
+#ifdef BCONFIG_SCAN_AVX2
+		case Scan_level::avx2 : return find_structurals_avx2(text,n,out);
+#endif
+#ifdef BCONFIG_SCAN_SSE2
+		case Scan_level::sse2 : return find_structurals_sse2(text,n,out);
+#endif
+		default : return find_structurals_scalar(text,0,n,out);
+	}
+}
+
+
+size_t detail::find_structurals(const char *text, size_t n, uint16_t *out){
+	return find_structurals(text,n,out,scan_level());
+}
+
+
+detail::Text detail::read_text(std::istream &in){
+	//read everything at once, keys and values are slices of this buffer
+	auto buffer = std::make_shared<std::string>();
+	char chunk[1<<16];
+	while(in.read(chunk,sizeof(chunk)) or in.gcount()>0){
+		buffer->append(chunk,static_cast<size_t>(in.gcount()));
+	}
+	std::string_view text(*buffer);
+	return Text{text,std::move(buffer)};
+}
+
+
+detail::Text detail::load_text(const std::string &path, const Parse_options &opt){
+#ifdef BCONFIG_COMPRESSED
+	const CompressedFile::Format f = CompressedFile::detect(path);
+	if(f!=CompressedFile::Format::none){
+		auto buffer = std::make_shared<std::string>(CompressedFile(path,f).read_all());
+		std::string_view text(*buffer);
+		return Text{text,std::move(buffer)};
+	}
+#endif
+
+#ifdef GZSTREAM_SUPPORT
+	const bool can_map = opt.mmap and !str::endWith(path,".gz");
+#else
+	const bool can_map = opt.mmap;
+#endif
+
+	if(can_map){
+		auto file = std::make_shared<const MappedFile>(path);
+		return Text{file->view(),file};
+	}
+
 	auto in = iOpenFile(path);
-	parse(*in,path);
+	return read_text(*in);
+}
+
+
+void BConfig::parse(std::istream &in, const std::string &path, const Parse_options &opt){
+#ifdef BCONFIG_COUNTERS
+	Parse_recorder r(opt);
+	detail::Text t = detail::read_text(in);
+	r.loaded(t.text);
+	parse_text(t.text,std::move(t.owner),path,r.opt);
+	r.done(path,opt);
+#else
+	detail::Text t = detail::read_text(in);
+	parse_text(t.text,std::move(t.owner),path,opt);
+#endif
+}
+
+
+void BConfig::parse(const std::string & path, const Parse_options &opt){
+#ifdef BCONFIG_COUNTERS
+	Parse_recorder r(opt);
+	const Parse_options &o = r.opt;
+#else
+	const Parse_options &o = opt;
+#endif
+	Include_scope scope(include_chain_of(path,o));
+
+#ifdef BCONFIG_COMPRESSED
+	//a sequential parse of a compressed file : decompress and parse at the same time
+	if(o.threads==1 and !o.lazy and CompressedFile::detect(path)!=CompressedFile::Format::none){
+		parse_pipelined(path,o);
+	}else
+#endif
+	{
+		detail::Text t = detail::load_text(path,o);
+#ifdef BCONFIG_COUNTERS
+		r.loaded(t.text);
+#endif
+		parse_text(t.text,std::move(t.owner),path,o);
+	}
+
+#ifdef BCONFIG_COUNTERS
+	r.done(path,opt);
+#endif
+}
+
+
+namespace{
+	//the files of load_many, shared between threads : each thread takes from the front of its share, and steals from the back of the others
+	struct Load_queue{
+		//a share of the files : [begin,end) packed in one word, changed by compare and swap
+		struct alignas(64) Share{std::atomic<uint64_t> range{0};};
+
+		static constexpr size_t none = std::numeric_limits<size_t>::max();
+
+		Load_queue(size_t files, size_t threads):shares(threads){
+			for(size_t i=0; i<threads; ++i){shares[i].range = pack(files*i/threads,files*(i+1)/threads);}
+		}
+
+		//the next file for thread t, none when every share is empty
+		size_t take(size_t t){
+			size_t R = take_front(shares[t]);
+			for(size_t i=1; R==none and i<shares.size(); ++i){R = take_back(shares[(t+i)%shares.size()]);}
+			return R;
+		}
+
+	private:
+		static uint64_t pack(size_t begin, size_t end){return (static_cast<uint64_t>(begin)<<32)|end;}
+
+		static size_t take_front(Share &s){
+			uint64_t r = s.range.load();
+			while(true){
+				const size_t begin=r>>32, end=r&0xffffffff;
+				if(begin==end){return none;}
+				if(s.range.compare_exchange_weak(r,pack(begin+1,end))){return begin;}
+			}
+		}
+
+		static size_t take_back(Share &s){
+			uint64_t r = s.range.load();
+			while(true){
+				const size_t begin=r>>32, end=r&0xffffffff;
+				if(begin==end){return none;}
+				if(s.range.compare_exchange_weak(r,pack(begin,end-1))){return end-1;}
+			}
+		}
+
+		std::vector<Share> shares;
+	};
+
+
+#ifdef BCONFIG_POSIX_FILES
+	//a file opened ahead, the system reads it while the previous file is parsed
+	struct Prefetched_file{
+		int fd=-1;
+
+		explicit Prefetched_file(const std::string &path){
+			fd = ::open(path.c_str(),O_RDONLY|O_CLOEXEC);
+#ifdef POSIX_FADV_WILLNEED
+			if(fd>=0){::posix_fadvise(fd,0,0,POSIX_FADV_WILLNEED);}
+#endif
+		}
+		~Prefetched_file(){if(fd>=0){::close(fd);}}
+
+		Prefetched_file(const Prefetched_file &)=delete;
+		Prefetched_file &operator=(const Prefetched_file &)=delete;
+	};
+
+
+	//small files read one after the other into a shared buffer, the trees of the files own it together
+	struct Text_slab{
+		static constexpr size_t slab_size = 1<<20;
+
+		//read the content of f into the slab, false if the file cannot be read that way (use load_text)
+		bool read(const Prefetched_file &f, detail::Text &R){
+			struct stat st;
+			if(f.fd<0 or ::fstat(f.fd,&st)!=0 or !S_ISREG(st.st_mode)){return false;}
+			const size_t size = static_cast<size_t>(st.st_size);
+			if(size>slab_size/4){return false;} //large files get their own buffer
+
+			if(buffer==nullptr or slab_size-used<size+1){
+				buffer = std::shared_ptr<char[]>(new char[slab_size]);
+				used   = 0;
+			}
+
+			//one byte more than the size : a file that grew is read by load_text
+			char  *p = buffer.get()+used;
+			size_t n = 0;
+			while(n<size+1){
+				const ssize_t r = ::read(f.fd,p+n,size+1-n);
+				if(r<0 and errno==EINTR){continue;}
+				if(r<0){return false;}
+				if(r==0){break;}
+				n += static_cast<size_t>(r);
+			}
+			if(n>size){return false;}
+
+			//compressed files are decompressed by load_text
+			if(n>=2 and static_cast<unsigned char>(p[0])==0x1f and static_cast<unsigned char>(p[1])==0x8b){return false;}
+			if(n>=4 and std::string_view(p,4)=="\x28\xb5\x2f\xfd"){return false;}
+
+			used   += n;
+			R.text  = std::string_view(p,n);
+			R.owner = buffer;
+			return true;
+		}
+
+	private:
+		std::shared_ptr<char[]> buffer;
+		size_t                  used=0;
+	};
+#else
+	//without POSIX files, nothing is opened ahead and each file is loaded by BConfig(path,opt)
+	struct Prefetched_file{
+		explicit Prefetched_file(const std::string &){}
+	};
+
+	struct Text_slab{
+		bool read(const Prefetched_file &, detail::Text &){return false;}
+	};
+#endif
+}
+
+
+
+std::vector<Load_result> bconfig::load_many(const std::vector<std::string> &paths, const Parse_options &opt){
+	std::vector<Load_result> R(paths.size());
+	if(paths.empty()){return R;}
+
+	Parse_options file_opt = opt;
+	file_opt.threads = 1;
+	file_opt.stats   = nullptr;
+
+	const unsigned threads = opt.threads!=0 ? opt.threads : std::max(1u,std::thread::hardware_concurrency());
+	const size_t   pool_size = std::min<size_t>(threads,paths.size());
+	Load_queue queue(paths.size(),pool_size);
+
+	auto load = [&](size_t i, const Prefetched_file &f, Text_slab &slab){
+		const std::string &path = paths[i];
+		try{
+#ifdef BCONFIG_COUNTERS
+			Parse_recorder r(file_opt);
+			const Parse_options &o = r.opt;
+#else
+			const Parse_options &o = file_opt;
+#endif
+			detail::Text t;
+			if(o.mmap or !slab.read(f,t)){
+				R[i].config = BConfig(path,file_opt);
+				return;
+			}
+#ifdef BCONFIG_COUNTERS
+			r.loaded(t.text);
+#endif
+			Include_scope scope(include_chain_of(path,o));
+			R[i].config.parse_text(t.text,std::move(t.owner),path,o);
+#ifdef BCONFIG_COUNTERS
+			r.done(path,file_opt);
+#endif
+		}catch(...){
+			R[i].config = BConfig();
+			R[i].error  = std::current_exception();
+		}
+	};
+
+	auto work = [&](size_t t){
+		Text_slab slab;
+		size_t i = queue.take(t);
+		if(i==Load_queue::none){return;}
+		auto f = std::make_unique<Prefetched_file>(paths[i]);
+		while(i!=Load_queue::none){
+			//open the next file before parsing this one
+			const size_t next = queue.take(t);
+			std::unique_ptr<Prefetched_file> next_f;
+			if(next!=Load_queue::none){next_f = std::make_unique<Prefetched_file>(paths[next]);}
+			load(i,*f,slab);
+			i = next;
+			f = std::move(next_f);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for(size_t t=1; t<pool_size; ++t){pool.emplace_back(work,t);}
+	work(0);
+	for(std::thread &t : pool){t.join();}
+	return R;
+}
+
+
+
+#ifdef BCONFIG_COMPRESSED
+namespace{
+	//decompresses a file on its own thread, in pieces cut between lines, for BConfig::parse_pipelined.
+	//Pieces are not reused : keys and values point into them. At most max_pieces wait for the parser.
+	struct Pipelined_reader{
+		static constexpr size_t piece_size = 1<<22;
+		static constexpr size_t max_pieces = 4;
+
+		explicit Pipelined_reader(const std::string &path):file(path,CompressedFile::detect(path)){
+			thread = std::thread(&Pipelined_reader::run,this);
+		}
+
+		~Pipelined_reader(){
+			{
+				std::lock_guard<std::mutex> lock(m);
+				stop = true;
+			}
+			cv.notify_all();
+			thread.join();
+		}
+
+		/**\brief wait for the next piece
+		 * \return false at the end of the file
+		 * \throw the decompression errors*/
+		bool next(detail::Text &R){
+			std::unique_lock<std::mutex> lock(m);
+			cv.wait(lock,[&](){return !pieces.empty() or done;});
+			if(pieces.empty()){
+				if(error){std::rethrow_exception(error);}
+				return false;
+			}
+			std::shared_ptr<std::string> p = std::move(pieces.front());
+			pieces.pop_front();
+			lock.unlock();
+			cv.notify_all();
+
+			R.text  = *p;
+			R.owner = std::move(p);
+			return true;
+		}
+
+	private:
+		void run(){
+			try{
+				std::string carry; //the end of the previous piece, after its last line
+				while(true){
+					auto piece = std::make_shared<std::string>();
+					piece->swap(carry);
+
+					//fill the piece, grow it until it holds a whole line
+					size_t size=piece->size(), cut=0;
+					bool   end=false;
+					while(cut==0 and !end){
+						piece->resize(std::max(piece_size,2*size));
+						const size_t want = piece->size()-size;
+						const size_t n    = file.read(&(*piece)[size],want);
+						end   = n<want;
+						size += n;
+						size_t eol = std::string_view(*piece).substr(0,size).rfind('\n');
+						cut = eol==std::string_view::npos ? 0 : eol+1;
+					}
+
+					if(end){cut=size;}
+					carry.assign(*piece,cut,size-cut);
+					piece->resize(cut);
+					if(piece->capacity()>2*piece->size()){piece->shrink_to_fit();} //the last piece
+
+					std::unique_lock<std::mutex> lock(m);
+					cv.wait(lock,[&](){return pieces.size()<max_pieces or stop;});
+					if(stop){return;}
+					if(!piece->empty()){pieces.push_back(std::move(piece));}
+					if(end){break;}
+					lock.unlock();
+					cv.notify_all();
+				}
+			}catch(...){
+				std::lock_guard<std::mutex> lock(m);
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m);
+				done = true;
+			}
+			cv.notify_all();
+		}
+
+		CompressedFile file;
+		std::thread    thread;
+
+		std::mutex              m;
+		std::condition_variable cv;
+		std::deque<std::shared_ptr<std::string> > pieces;
+		bool               stop=false;
+		bool               done=false;
+		std::exception_ptr error;
+	};
+}
+#endif
+
+
+void BConfig::parse_pipelined(const std::string &path, const Parse_options &opt){
+#ifdef BCONFIG_COMPRESSED
+	if(storage==nullptr){storage = std::make_shared<detail::Text_storage>();}
+	own_body(); //parse appends : parse the content first
+
+	Pipelined_reader reader(path);
+	detail::Parse_position pos;
+
+	auto parse_pieces = [&](auto &h){
+		h.stack.push_back(this);
+		h.set_options(path,opt);
+		detail::Text t;
+		while(!pos.ended){
+#ifdef BCONFIG_COUNTERS
+			const auto t0 = std::chrono::steady_clock::now();
+			const bool more = reader.next(t);
+			if(opt.stats!=nullptr){
+				opt.stats->io_time += std::chrono::steady_clock::now()-t0;
+				if(more){opt.stats->bytes += t.text.size(); opt.stats->lines += count_lines(t.text);}
+			}
+			if(!more){break;}
+#else
+			if(!reader.next(t)){break;}
+#endif
+			storage->add(std::move(t.owner),t.text);
+			detail::parse_events_part(t.text,h,path,pos);
+		}
+	};
+
+#ifdef BCONFIG_COUNTERS
+	if(opt.stats!=nullptr){
+		detail::Counting_tree_builder h(*opt.stats);
+		const auto t0     = std::chrono::steady_clock::now();
+		const auto io0    = opt.stats->io_time;
+		parse_pieces(h);
+		opt.stats->tokenize_time += std::chrono::steady_clock::now()-t0-(opt.stats->io_time-io0)-opt.stats->build_time;
+		return;
+	}
+#endif
+
+	detail::Tree_builder h;
+	parse_pieces(h);
+#else
+	detail::Text t = detail::load_text(path,opt);
+	parse_text(t.text,std::move(t.owner),path,opt);
+#endif
+}
+
+
+void BConfig::parse_lazy_blocks()const{
+	for(const auto &b : body().blocks){b.second.parse_lazy_blocks();}
+}
+
+
+bool BConfig::operator==(const BConfig &other)const{
+	const BConfig &a = body();
+	const BConfig &b = other.body();
+	if(&a==&b){return true;}
+	if(a.values.size()!=b.values.size() or a.blocks.size()!=b.blocks.size()){return false;}
+
+	for(const auto &v : a.values){
+		const detail::Value_list *f = b.find_values(v.first);
+		if(f==nullptr or f->text!=v.second.text){return false;}
+	}
+
+	for(size_t i=0; i<a.blocks.size(); ++i){
+		if(a.blocks[i].first!=b.blocks[i].first or a.blocks[i].second!=b.blocks[i].second){return false;}
+	}
+	return true;
+}
+
+
+namespace{
+	//size of a heap block of n bytes : malloc adds a header and rounds up to 16 bytes
+	size_t heap_block(size_t n){
+		if(n==0){return 0;}
+		return std::max<size_t>(32,(n+sizeof(size_t)+15)/16*16);
+	}
+
+	//a std::deque allocates a map of buffer pointers and fixed size buffers, even when empty (libstdc++ layout)
+	template<typename T>
+	size_t deque_bytes(const std::deque<T> &d){
+		const size_t per_buffer = sizeof(T)<512 ? 512/sizeof(T) : 1;
+		const size_t buffers    = d.size()/per_buffer+1;
+		return heap_block(std::max<size_t>(8,buffers+2)*sizeof(void*)) + buffers*heap_block(per_buffer*sizeof(T));
+	}
+
+	template<typename T>
+	size_t vector_bytes(const std::vector<T> &v){return heap_block(v.capacity()*sizeof(T));}
+
+	//one heap block per element (with the next pointer and the cached hash), and the buckets
+	template<typename M>
+	size_t map_bytes(const M &m){
+		const size_t buckets = m.bucket_count()>1 ? heap_block(m.bucket_count()*sizeof(void*)) : 0;
+		return buckets + m.size()*heap_block(sizeof(void*)+sizeof(typename M::value_type)+sizeof(size_t));
+	}
+}
+
+
+Memory_usage &Memory_usage::operator+=(const Memory_usage &m){
+	nodes          +=m.nodes;
+	keys           +=m.keys;
+	values         +=m.values;
+	key_bytes      +=m.key_bytes;
+	value_bytes    +=m.value_bytes;
+	container_bytes+=m.container_bytes;
+	text_bytes     +=m.text_bytes;
+	return *this;
+}
+
+
+void BConfig::add_memory_usage(Memory_usage &R)const{
+	++R.nodes;
+
+	//an unparsed lazy block holds its text only, do not parse it to measure it
+	const BConfig *n = this;
+	if(lazy){
+		R.container_bytes += heap_block(sizeof(detail::Lazy_block)+2*sizeof(void*)) + heap_block(lazy->path->size()+1);
+		if(!lazy->parsed.load(std::memory_order_acquire)){return;}
+		n = &lazy->tree;
+	}
+
+	R.keys += n->values.size()+n->block_index.size();
+	R.container_bytes += map_bytes(n->values) + map_bytes(n->block_index) + deque_bytes(n->blocks);
+
+	for(const auto &v : n->values){
+		R.values          += v.second.text.size();
+		R.key_bytes       += v.first.name.size();
+		R.container_bytes += deque_bytes(v.second.text) + vector_bytes(v.second.decoded);
+		for(std::string_view t : v.second.text){R.value_bytes += t.size();}
+	}
+
+	for(const auto &i : n->block_index){R.container_bytes += vector_bytes(i.second);}
+
+	for(const auto &b : n->blocks){
+		R.key_bytes += b.first.size();
+		b.second.add_memory_usage(R);
+	}
+}
+
+
+Memory_usage BConfig::memory_usage()const{
+	Memory_usage R;
+	R.container_bytes = sizeof(BConfig);
+	add_memory_usage(R);
+	if(storage){R.text_bytes = storage->bytes();}
+	return R;
+}
+
+
+namespace{
+	std::ostream &operator<<(std::ostream &out, const Memory_usage &m){
+		return out << "nodes=" << m.nodes << " keys=" << m.keys << " values=" << m.values
+		           << " key_bytes=" << m.key_bytes << " value_bytes=" << m.value_bytes << " container_bytes=" << m.container_bytes;
+	}
+}
+
+
+void BConfig::print_memory_usage(std::ostream &out, size_t max_depth)const{
+	const Memory_usage m = memory_usage();
+	out << "total : " << m << " text_bytes=" << m.text_bytes << " total_bytes=" << m.total() << "\n";
+	print_memory_usage(out,"",0,max_depth);
+}
+
+
+void BConfig::print_memory_usage(std::ostream &out, std::string_view key, size_t depth, size_t max_depth)const{
+	if(depth>0){
+		Memory_usage m;
+		m.container_bytes = sizeof(key_block_t);
+		add_memory_usage(m);
+		indent(out,depth-1);
+		out << key << "{ " << m << " }\n";
+	}
+	if(depth>=max_depth){return;}
+	if(lazy and !lazy->parsed.load(std::memory_order_acquire)){return;}
+	for(const auto &b : body().blocks){b.second.print_memory_usage(out,b.first,depth+1,max_depth);}
 }
 
 
 void BConfig::print(std::ostream &out, size_t indent_v)const{
-	for(const auto &v : values){
+	const BConfig &n = body();
+	for(const auto &v : n.values){
 		indent(out,indent_v);
 		//out <<v.first<<":{";
-		for(const auto &vv :v.second ){out <<v.first<<"="<< vv <<"\n";}
+		for(const auto &vv :v.second.text ){out <<v.first.name<<"="<< vv <<"\n";}
 		//out << "}\n";
 	}
 
-	for(const auto &b : blocks){
+	for(const auto &b : n.blocks){
 		indent(out,indent_v);
 		out << b.first <<"{\n";
 		b.second.print(out,indent_v+1);
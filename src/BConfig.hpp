@@ -25,140 +25,350 @@
 
 //needed for header
 #include <deque>
+#include <exception>
 #include <unordered_map>
 #include <istream>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <cstdint>
+#include <vector>
 
 #include "BConfig_error.hpp"
 #include "BConfig_convert.hpp"
+#include "BConfig_counters.hpp"
+#include "BConfig_key.hpp"
 
 
 
 
 namespace bconfig{
 
+/**\brief Options for BConfig::parse(const std::string &path, const Parse_options &)*/
+struct Parse_options{
+	/**\brief map the file in memory instead of reading it.
+	 * Keys and values are then slices of the mapping, which is owned by the tree and released with its last BConfig.
+	 * The file must not be truncated while a BConfig parsed from it is alive. Ignored for compressed files.*/
+	bool mmap=false;
+
+	/**\brief classify each value once while parsing (integer, floating point, yes/no or string) and keep its decoded form.
+	 * BConfig::get_unique_value, BConfig::get_values and BConfig::get_yes_no then return the decoded form without converting the text again.
+	 * Types that do not match the decoded form (e.g., float, custom types) still use Convert_t.*/
+	bool decode_values=false;
+
+	/**\brief number of threads used to parse, 0 = std::thread::hardware_concurrency().
+	 * With more than one thread, a large input is cut at top-level block boundaries by a fast pre-scan, the pieces are parsed concurrently
+	 * and appended in input order. The tree and the errors (line numbers included) are the same as with a sequential parse.*/
+	unsigned threads=1;
+
+	/**\brief parse only the top-level lines, and record the text of each block. A block is parsed the first time it is accessed
+	 * (any getter, BConfig::print, BConfig_flat ...), once, even when several threads access it. Copies of a block share the parse.
+	 * Blocks are skipped by matching braces only, so errors inside a block are thrown by the getter that first accesses it.
+	 * The text must stay alive : it is owned by the tree, as with a normal parse. Parse_options::threads is ignored.*/
+	bool lazy=false;
+
+	/**\brief a value line "include = path" is replaced by the values and the blocks of the file located at path, at any depth.
+	 * A relative path is relative to the directory of the including file. Included files may include other files, a cycle is an error.
+	 * Included files are parsed once per version (device, inode, modification time and size), then shared by every tree that includes them,
+	 * in the whole process (see clear_include_cache) : their blocks are immutable subtrees, copied on the first modification only.
+	 * Included files are always read, never mapped : Parse_options::mmap applies to the including file only.
+	 * Errors in an included file give its path and line, followed by ", included from " and the including file.*/
+	bool include=false;
+
+	/**\brief if not null, filled with the statistics of each parse done with these options (see BConfig_counters.hpp).
+	 * Only when BCONFIG_COUNTERS is defined, otherwise it is left untouched. Timing the tree building reads the clock twice per line.*/
+	Parse_stats *stats=nullptr;
+};
+
+
+/**\brief Options for BConfig::serialize*/
+struct Serialize_options{
+	enum struct Order : unsigned char{
+		input, /*!< keys in the order of their first value in the input. Values of a key and blocks are always in input order.
+		        Exception : keys whose first value comes from an included file (Parse_options::include) are written after the other keys of their block,
+		        in the order of the included texts, not at the position of the include line.*/
+		sorted /*!< keys sorted as bytes*/
+	};
+
+	/**\brief order of the keys of each block. Both orders are deterministic : the same tree gives the same bytes.*/
+	Order order=Order::input;
+
+	/**\brief no indentation. The output is smaller and parses to the same tree.*/
+	bool compact=false;
+};
+
+
+namespace detail{
+	/**\brief Keeps alive the text buffers (file mappings or strings) that keys and values of a tree point into.
+	 * Shared by all the BConfig of a tree, including copies.*/
+	struct Text_storage{
+		/**\brief keep buffer alive, text is its content*/
+		void add(std::shared_ptr<const void> buffer, std::string_view text){
+			std::lock_guard<std::mutex> lock(m);
+			buffers.push_back(std::move(buffer));
+			p_texts.push_back(text);
+		}
+
+		/**\brief keep buffer alive, the texts are its content. Does nothing if buffer was already added this way*/
+		void add_once(std::shared_ptr<const void> buffer, const std::vector<std::string_view> &texts){
+			std::lock_guard<std::mutex> lock(m);
+			for(const auto &b : buffers){if(b==buffer){return;}}
+			buffers.push_back(std::move(buffer));
+			p_texts.insert(p_texts.end(),texts.begin(),texts.end());
+		}
+
+		/**\return the size of the buffers*/
+		size_t bytes(){
+			std::lock_guard<std::mutex> lock(m);
+			size_t R=0;
+			for(std::string_view t : p_texts){R+=t.size();}
+			return R;
+		}
+
+		/**\return the content of the buffers, in the order they were added*/
+		std::vector<std::string_view> texts(){
+			std::lock_guard<std::mutex> lock(m);
+			return p_texts;
+		}
+	private:
+		std::mutex m;
+		std::vector<std::shared_ptr<const void> > buffers;
+		std::vector<std::string_view>             p_texts;
+	};
+
+	/**\brief A value decoded at parse time, see Parse_options::decode_values*/
+	struct Decoded{
+		enum struct Kind : unsigned char {string, integer, floating, yes_no};
+		Kind kind=Kind::string;
+		union{
+			long long integer;
+			double    floating;
+			bool      yes_no;
+		};
+		Decoded():integer(0){}
+
+		/**\brief classify and decode s*/
+		static Decoded decode(std::string_view s);
+
+		/**\brief get the decoded value as T
+		 * \return false if T does not match the decoded value, the value must then be converted from its text*/
+		template<typename T> bool get(T &R)const;
+	};
+
+	/**\brief The values of a key, in input order. decoded is empty, or parallel to text when values are decoded.*/
+	struct Value_list{
+		std::deque<std::string_view> text;
+		std::vector<Decoded>         decoded;
+	};
+
+	/**\brief A whole input text, and what keeps it alive (a buffer or a file mapping)*/
+	struct Text{
+		std::string_view            text;
+		std::shared_ptr<const void> owner;
+	};
+
+	/**\brief read in until the end*/
+	Text read_text(std::istream &in);
+
+	/**\brief read or map (see Parse_options::mmap) the file located at path
+	 * \throw Error_OpenFile if the file cannot be opened*/
+	Text load_text(const std::string &path, const Parse_options &opt);
+
+	struct Flat_builder; //see BConfig_flat.hpp
+	struct Tree_builder; //see BConfig.cpp
+	struct Lazy_block;   //see BConfig.cpp
+	struct Include_cache;//see BConfig.cpp
+	struct Serializer;   //see BConfig_serialize.cpp
+}
+
+/**\brief Memory used by a BConfig and its sub-blocks, see BConfig::memory_usage.
+ * Container bytes are estimated from the sizes and capacities of the standard containers, and include the allocator overhead.*/
+struct Memory_usage{
+	size_t nodes          =0; /*!< BConfig nodes : this one and its sub-blocks, recursively*/
+	size_t keys           =0; /*!< keys of each node, value keys and block keys counted once per node*/
+	size_t values         =0; /*!< values*/
+	size_t key_bytes      =0; /*!< text of the keys of values and blocks*/
+	size_t value_bytes    =0; /*!< text of the values*/
+	size_t container_bytes=0; /*!< nodes, hash tables, deques, vectors and lazy blocks*/
+	size_t text_bytes     =0; /*!< input text owned by the tree (file contents or mappings), shared by all its nodes and copies. Keys and values point into it.*/
+
+	/**\return bytes used by the tree : key_bytes and value_bytes are part of text_bytes*/
+	size_t total()const{return container_bytes+text_bytes;}
+
+	Memory_usage &operator+=(const Memory_usage &m);
+};
+
+struct Query; //see BConfig_query.hpp
+template<typename T> struct Schema; //see BConfig_schema.hpp
+struct Load_result; //see load_many
+
+
 /**\brief A simple configuration file library
  * 		The input file is the description of a tree composed of BConfig (i.e., leaves).
  * 		BConfig are identified by a that can map to 0,1 or more BConfig (i.e., childrens).
  * 		BConfig contains values identified by a key that can map to 0,1 or more values.
+ * 		Keys are taken as std::string_view, so std::string, std::string_view and literals are looked up without allocation.
+ * 		They are converted to Key, which carries the hash : "size"_key (see BConfig_key.hpp) is looked up without hashing.
  */
 struct BConfig{
 
 	BConfig()               =default;/*!<\brief construct an empty BConfig. use BConfig::parse to fill it.*/
 	BConfig(const BConfig &)=default;/*!<\brief efault copy constructor.*/
+	BConfig(BConfig &&)noexcept=default;/*!<\brief default move constructor, views into the text stay valid. noexcept : containers of BConfig move trees when they grow, instead of copying them.*/
+	BConfig &operator=(const BConfig &)=default;/*!<\brief default copy assignment.*/
+	BConfig &operator=(BConfig &&)noexcept=default;/*!<\brief default move assignment.*/
 	~BConfig()              =default;/*!<\brief default destructor*/
 
 	/** \brief Load a file located at path, see BConfig::parse for detail
-	 * \param path const std::string &. Input file path*/
-	explicit BConfig(const std::string &path){parse(path);}
+	 * \param path const std::string &. Input file path
+	 * \param opt const Parse_options &. How to read the file*/
+	explicit BConfig(const std::string &path, const Parse_options &opt=Parse_options()){parse(path,opt);}
 
 	/**\brief load from std::istream, see BConfig::parse for detail
 	 * \param path_description const std::string &, default = "".Input file path description, used only for throwing explicit errors.
 	 * \param in std::istream &. Read config from this std::istream.
 	 */
-	explicit BConfig(std::istream &in,const std::string &path_description="" ){parse(in,path_description);}
+	explicit BConfig(std::istream &in,const std::string &path_description="", const Parse_options &opt=Parse_options()){parse(in,path_description,opt);}
 
 	/**\return true if exactly one value for key, false otherwise
-	 * \param key const std::string &. The key*/
-	bool has_unique_value(const std::string &key)const;
+	 * \param key Key. The key*/
+	bool has_unique_value(Key key)const;
 
 	/**\return true if one or more value for key, false if no value for key
-	 * \param key const std::string &. The key*/
-	bool has_values       (const std::string &key)const;
+	 * \param key Key. The key*/
+	bool has_values       (Key key)const;
 
 	/**\return the number of values for the key
-	 * \param key const std::string &. The key*/
-	size_t count_values(const std::string &key)const;
+	 * \param key Key. The key*/
+	size_t count_values(Key key)const;
 
 
 
 
 	/**
 	 * \tparam return_t The type of value to get. Values are converted from std::string to return_t by BConfig::convert.
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
 	 * \throw Error_BConfig_get if no values.
 	 * \return a not empty std::deque<return_t> containing the values associated to the key in the current blockk in the same order as they appear in input file
 	 */
 	template< typename return_t = std::string>
-	const std::deque<return_t> get_values(const std::string &key,bool do_throw=true)const;
+	std::deque<return_t> get_values(Key key,bool do_throw=true)const;
 
-	/**\brief convenience wrapper for const char* key, see BConfig::get_values<return_t>(const std::string &key)const*/
-	template< typename return_t = std::string>
-	const std::deque<return_t> get_values(const char *key,bool do_throw=true)const{return get_values<return_t>(std::string(key),do_throw);}
 
 
 	/**
 	 * \tparam return_t The type of value to get. Values are converted from std::string to return_t by BConfig::convert.
-	 * \param key const std::string &. The key.
+	 * \param key Key. The key.
 	 * \throw Error_BConfig_get if not exactly one value.
 	 * \throw Error_BConfig_convert if conversion fails (see BConfig::convert).
 	 * \return the unique value associated to key in the current blockk
 	 */
 	template< typename return_t = std::string>
-	return_t get_unique_value(const std::string &key) const;
+	return_t get_unique_value(Key key) const;
 
-	/**\brief convenience wrapper for const char* key, see BConfig::get_unique_value<return_t>(const std::string &key)const*/
-	template< typename return_t = std::string>
-	return_t get_unique_value(const char* &key) const{return get_unique_value<return_t>(std::string(key));}
 
 
 
+	/**
+	 * \param key Key. The key
+	 * \param do_throw bool. If true throw a Error_BConfig_get error if there is no value.
+	 * \throw Error_BConfig_get if do_throw==true and no values.
+	 * \return the values associated to the key, in the same order as they appear in input file.
+	 * The views point into the text owned by the tree: they are valid as long as a BConfig of this tree is alive. Nothing is allocated.
+	 */
+	const std::deque<std::string_view> &get_values_view(Key key,bool do_throw=true)const;
+
+	/**
+	 * \param key Key. The key.
+	 * \throw Error_BConfig_get if not exactly one value.
+	 * \return a view on the unique value associated to key, see BConfig::get_values_view for lifetime. Nothing is allocated.
+	 */
+	std::string_view get_value_view(Key key)const;
+
+
 	/**
 	 * \tparam return_t The type of value to get. Values are converted from std::string to return_t by BConfig::convert.
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
 	 * \param default_v const return_t &, the default value to return if the key is missing.
 	 * \throw Error_BConfig_get if more than one value.
 	 * \throw Error_BConfig_convert if conversion fails (see BConfig::convert).
 	 * \return default_v if key is missing, or a unique value otherwise.
 	 */
 	template< typename return_t = std::string>
-	return_t get_unique_value(const std::string &key, const return_t &default_v)const;
+	return_t get_unique_value(Key key, const return_t &default_v)const;
 
-	/**\brief convenience wrapper for const char* key, see BConfig::get_unique_value<return_t>(const std::string &key,return_t & default_v)const*/
-	template< typename return_t = std::string>
-	return_t get_unique_value(const char* key, const return_t &default_v)const{return get_unique_value<return_t>(std::string(key),default_v);}
 
 
 	/**
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
 	 * \param throw_b bool. If true throw a Error_BConfig_get error if 0 sub-BConfig are found.
 	 * \throw Error_BConfig_get if throw_b==true and 0  sub-BConfig are found.
 	 * \return std::deque<BConfig> containing the sub-BConfig in the same order as they appear in input file
 	 */
-	const std::deque<BConfig> get_blocks (const std::string &key, bool throw_b=true)const;
+	std::deque<BConfig> get_blocks (Key key, bool throw_b=true)const &;
+
+	/**\brief see BConfig::get_blocks, the sub-BConfig are moved out of this temporary instead of copied (e.g., BConfig(path).get_blocks("server")).
+	 * They are copied if the content of this is shared with another BConfig (a lazy block, see Parse_options::lazy).*/
+	std::deque<BConfig> get_blocks (Key key, bool throw_b=true)&&;
 
 	/**
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
 	 * \throw Error_BConfig_get if not exactly one sub-BConfig are found.
 	 * \return the unique sub-BConfig associated to the key.
 	 */
-	const BConfig get_unique_block(const std::string &key)const;
+	BConfig get_unique_block(Key key)const &;
+
+	/**\brief see BConfig::get_unique_block, the sub-BConfig is moved out of this temporary instead of copied (see get_blocks)*/
+	BConfig get_unique_block(Key key)&&;
 
 
 	/**
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
 	 * \return the number of blocks associated to key
 	 */
-	size_t count_blocks(const std::string &key)const;
+	size_t count_blocks(Key key)const;
 
 
+	struct Block_range;
+
 	/**
-	 * \param key const std::string &. The key
+	 * \param key Key. The key
+	 * \param throw_b bool. If true throw a Error_BConfig_get error if 0 sub-BConfig are found.
+	 * \throw Error_BConfig_get if throw_b==true and 0  sub-BConfig are found.
+	 * \return a range of const BConfig & on the sub-BConfig, in the same order as they appear in input file.
+	 * Nothing is copied, the range is invalidated by BConfig::parse on this BConfig.
+	 */
+	Block_range get_blocks_view(Key key, bool throw_b=true)const;
+
+	/**
+	 * \param key Key. The key
+	 * \throw Error_BConfig_get if not exactly one sub-BConfig are found.
+	 * \return a reference on the unique sub-BConfig associated to the key, nothing is copied.
+	 */
+	const BConfig &get_unique_block_ref(Key key)const;
+
+
+	/**
+	 * \param key Key. The key
 	 * \throw Error_BConfig_get if if key is missing
 	 * \throw Error_BConfig_get if the associated value is neither "yes","y","no" nor "n".
 	 * \throw Error_BConfig_get if there is more than one value for the key
 	 * \return true for "yes" or "y" , false for "no" or "n"
 	 */
-	bool get_yes_no(const std::string &key)const;
+	bool get_yes_no(Key key)const;
 
 
 	/**
-	 * \param key const std::string &. The key.
+	 * \param key Key. The key.
 	 * \param default_v bool. The default value to return if key is missing or if value is an empty string.
 	 * \throw Error_BConfig_get if the associated value is neither "yes","y","no" nor "n".
 	 * \throw Error_BConfig_get if there is more than one value for the key
 	 * \return true for "yes" or "y" , false for "no" or "n", or default_v if key is missing or value is an empty string
 	 */
-	bool get_yes_no(const std::string &key,bool default_v)const;
+	bool get_yes_no(Key key,bool default_v)const;
 
 
 
@@ -166,41 +376,267 @@ struct BConfig{
 
 	/**
 	 * \brief load a file.
+	 * gzip and zstd files are recognized by their first bytes (whatever their name) when BCONFIG_ZLIB or BCONFIG_ZSTD is defined (see helpers/CompressedFile.h).
+	 * A sequential parse (threads==1, not lazy) then decompresses the file on another thread, while it parses the lines already decompressed.
 	 * \param path const std::string &. Filepath to config file
+	 * \param opt const Parse_options &. How to read the file (e.g., memory mapped)
+	 * \throw Error_OpenFile if the file cannot be opened or decompressed
 	 * \throw Error_BConfig_parse if file is invalid
 	 */
-	void parse(const std::string & path);
+	void parse(const std::string & path, const Parse_options &opt=Parse_options());
 
 	/**
 	 * \brief load a file.
 	 * \param in std::istream &. Read config file from this flux.
 	 * \param path const std::string &. Filepath to config file, path is used as optional parameter to throw readable errors.
+	 * \param opt const Parse_options &. Parse options, Parse_options::mmap is ignored
 	 * \throw Error_BConfig_parse if file is invalid
 	 */
-	void parse(std::istream &in, const std::string &path="");
+	void parse(std::istream &in, const std::string &path="", const Parse_options &opt=Parse_options());
 
 	/**
 	 * \param out std::ostream &. Where to print, used for debug
 	 * \param indent_v std::ostream &. Indentation level
-	 * \brief write the parsed filed in a valid format, usefull for debug
+	 * \brief write the parsed filed in a valid format, usefull for debug. Use BConfig::serialize for deterministic and fast dumps.
 	 */
 	void print(std::ostream &out, size_t indent_v=0)const;
 
+	/**
+	 * \brief parse now the blocks not parsed yet (see Parse_options::lazy), recursively. Afterwards, getters never parse nor lock.
+	 */
+	void parse_lazy_blocks()const;
+
+	/**
+	 * \return true if b has the same values (same order for each key) and the same sub-blocks (same order), recursively.
+	 * Values are compared as text.
+	 */
+	bool operator==(const BConfig &b)const;
+	bool operator!=(const BConfig &b)const{return !(*this==b);}
+
+	/**
+	 * \return the memory used by this BConfig and its sub-blocks, without parsing lazy blocks (see Parse_options::lazy).
+	 * text_bytes is the text of the whole tree, that this BConfig keeps alive.
+	 */
+	Memory_usage memory_usage()const;
+
+	/**
+	 * \brief print the memory used by each sub-block, as print does for values, to find the largest sections
+	 * \param out std::ostream &. Where to print
+	 * \param max_depth size_t. Deeper blocks are included in their parent's line
+	 */
+	void print_memory_usage(std::ostream &out, size_t max_depth=1)const;
+
+
+	/**
+	 * \brief write the tree as text, without std::ostream. BConfig::parse gives back a tree equal to this one (see operator==).
+	 * Defined in BConfig_serialize.cpp, as the other serialize functions.
+	 * \param buffer char *. Where to write, must hold serialized_size(opt) bytes
+	 * \param size size_t. Size of buffer
+	 * \throw Error_BConfig_serialize if buffer is too small, nothing is written then
+	 * \return the number of bytes written
+	 */
+	size_t serialize(char *buffer, size_t size, const Serialize_options &opt=Serialize_options())const;
+
+	/**\return the text written by serialize, in a string allocated once*/
+	std::string serialize(const Serialize_options &opt=Serialize_options())const;
+
+#if defined(__unix__) || defined(__APPLE__)
+	/**
+	 * \brief write the text written by serialize to a file descriptor, through a fixed size buffer. POSIX systems only.
+	 * \throw Error_BConfig_serialize if writing fails
+	 */
+	void serialize(int fd, const Serialize_options &opt=Serialize_options())const;
+#endif
+
+	/**
+	 * \brief write the text written by serialize to a file (replaced if it exists), through a fixed size buffer
+	 * \throw Error_OpenFile if the file cannot be opened
+	 * \throw Error_BConfig_serialize if writing fails
+	 */
+	void serialize_file(const std::string &path, const Serialize_options &opt=Serialize_options())const;
+
+	/**\return the size of the text written by serialize*/
+	size_t serialized_size(const Serialize_options &opt=Serialize_options())const;
+
+
+	/**
+	 * \brief write the tree in the binary format of BConfig_flat (see BConfig_flat.hpp), defined in BConfig_flat.cpp.
+	 * \param path const std::string &. Output file path
+	 * \throw Error_OpenFile if the file cannot be written
+	 */
+	void save_binary(const std::string &path)const;
+
+	/**
+	 * \brief load a file written by save_binary, without parsing it. The file is mapped, keys and values point into the mapping.
+	 * Use BConfig_flat::load_binary to also skip building the tree. Defined in BConfig_flat.cpp.
+	 * \param path const std::string &. Input file path
+	 * \throw Error_OpenFile if the file cannot be opened
+	 * \throw Error_BConfig_parse if the file is not a valid binary file
+	 */
+	static BConfig load_binary(const std::string &path);
+
 
 private:
-	static const std::deque<BConfig>     &empty_blocks(){static std::deque<BConfig> i;return i;}
-	static const std::deque<std::string> &empty_values(){static std::deque<std::string> i;return i;}
+	friend struct detail::Flat_builder;
+	friend struct detail::Tree_builder;
+	friend struct detail::Lazy_block;
+	friend struct detail::Include_cache;
+	friend std::vector<Load_result> load_many(const std::vector<std::string> &paths, const Parse_options &opt);
+	friend struct Query;
+	template<typename T> friend struct Schema;
+	friend struct detail::Serializer;
+
+	static const std::deque<BConfig>          &empty_blocks(){static std::deque<BConfig> i;return i;}
+	static const std::deque<std::string>      &empty_values(){static std::deque<std::string> i;return i;}
+	static const std::deque<std::string_view> &empty_values_view(){static std::deque<std::string_view> i;return i;}
 
 
 	static void indent(std::ostream &out, size_t s){for(size_t i = 0;i<s;++i){out << "  ";}}
 
-	typedef std::pair<std::string, BConfig > key_block_t;
-	std::unordered_map<std::string, std::deque<std::string> > values; //key_values : values in a blockk are unordered
+	//parse a whole text buffer, owner keeps text alive
+	void parse_text(std::string_view text, std::shared_ptr<const void> owner, const std::string &path, const Parse_options &opt);
+
+	//parse a compressed file while another thread decompresses it, see helpers/CompressedFile.h
+	void parse_pipelined(const std::string &path, const Parse_options &opt);
+
+	//parse the lines of text that belong to this, record the text of the sub-blocks in Lazy_block
+	void parse_lazy(std::string_view text, const std::shared_ptr<const std::string> &path, size_t line_num, const Parse_options &opt);
+
+	//the parsed content of this : this, or the lazy block once parsed
+	const BConfig &body()const{return lazy==nullptr ? *this : lazy_body();}
+	const BConfig &lazy_body()const;
+
+	//parse the lazy content of this, and take it : moved out of the lazy block if no other BConfig shares it, copied otherwise
+	void own_body();
+
+	//add the memory of this and its sub-blocks to R, except the text
+	void add_memory_usage(Memory_usage &R)const;
+	void print_memory_usage(std::ostream &out, std::string_view key, size_t depth, size_t max_depth)const;
+
+	//cut text at top-level boundaries, parse the pieces on opt.threads threads, append them in order
+	void parse_parallel(std::string_view text, const std::string &path, const Parse_options &opt);
+
+	//move the values and the sub-blocks of b at the end of this, b must share the storage of this
+	void append(BConfig &&b);
+
+	//parse text in this, line_num is the number of lines before text
+	void parse_lines(std::string_view text, const std::string &path, size_t line_num, const Parse_options &opt);
+
+	//process the directive "include = path" found in the file from : append the content of path, parsed once per process (see Parse_options::include)
+	void include(std::string_view path, const std::string &from, const Parse_options &opt);
+
+	//append a value, and decode it if asked
+	void add_value(Key key, std::string_view value, bool decode);
+
+	//values of key, null if none
+	const detail::Value_list *find_values(Key key)const;
+
+	//values of key, throw if not exactly one value
+	const detail::Value_list &get_unique_list(Key key)const;
+
+	[[noreturn]] static void throw_multiple_values(std::string_view key, const std::deque<std::string_view> &d);
+
+	//append an empty sub-block and index it
+	BConfig &add_block(Key key);
+
+	//positions in blocks of the sub-blocks with key, null if none
+	const std::vector<uint32_t> *find_blocks(Key key)const;
+
+	typedef std::pair<std::string_view, BConfig > key_block_t;
+	std::unordered_map<Key, detail::Value_list, detail::Key_hash > values; //key_values : values in a blockk are unordered
 	std::deque< key_block_t >     blocks ; //blockks are ordered
+	std::unordered_map<Key, std::vector<uint32_t>, detail::Key_hash > block_index; //key -> positions in blocks, in input order
+	std::shared_ptr<detail::Text_storage> storage; //owns the text keys and values point into
+	std::shared_ptr<detail::Lazy_block>   lazy;    //not null : the content is not parsed yet, see Parse_options::lazy
+
+
+};
 
 
+
+/**\brief The sub-blocks of a BConfig that have the same key, see BConfig::get_blocks_view.
+ * A random access range of const BConfig &, backed by the block index of the parent.*/
+struct BConfig::Block_range{
+	struct iterator{
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef BConfig                         value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef const BConfig*                  pointer;
+		typedef const BConfig&                  reference;
+
+		iterator()=default;
+		iterator(const std::deque<key_block_t> *blocks_, const uint32_t *i_):blocks(blocks_),i(i_){}
+
+		reference operator* ()const{return  (*blocks)[*i].second;}
+		pointer   operator->()const{return &(*blocks)[*i].second;}
+		reference operator[](difference_type n)const{return (*blocks)[i[n]].second;}
+
+		iterator &operator++()     {++i;return *this;}
+		iterator  operator++(int)  {iterator r=*this; ++i; return r;}
+		iterator &operator--()     {--i;return *this;}
+		iterator  operator--(int)  {iterator r=*this; --i; return r;}
+		iterator &operator+=(difference_type n){i+=n;return *this;}
+		iterator &operator-=(difference_type n){i-=n;return *this;}
+		iterator  operator+ (difference_type n)const{return iterator(blocks,i+n);}
+		iterator  operator- (difference_type n)const{return iterator(blocks,i-n);}
+		difference_type operator-(const iterator &o)const{return i-o.i;}
+
+		bool operator==(const iterator &o)const{return i==o.i;}
+		bool operator!=(const iterator &o)const{return i!=o.i;}
+		bool operator< (const iterator &o)const{return i< o.i;}
+		bool operator> (const iterator &o)const{return i> o.i;}
+		bool operator<=(const iterator &o)const{return i<=o.i;}
+		bool operator>=(const iterator &o)const{return i>=o.i;}
+
+	private:
+		const std::deque<key_block_t> *blocks=nullptr;
+		const uint32_t                *i     =nullptr;
+	};
+
+	Block_range()=default;
+	Block_range(const std::deque<key_block_t> &blocks_, const std::vector<uint32_t> &index):
+		b(&blocks_,index.data()),e(&blocks_,index.data()+index.size()){}
+
+	iterator begin()const{return b;}
+	iterator end  ()const{return e;}
+	bool     empty()const{return b==e;}
+	size_t   size ()const{return static_cast<size_t>(e-b);}
+	const BConfig &operator[](size_t n)const{return b[static_cast<std::ptrdiff_t>(n)];}
+
+private:
+	iterator b, e;
+};
+
+
+/**\brief forget the files parsed for include directives (see Parse_options::include). Trees that included them keep their subtrees.*/
+void clear_include_cache();
+
+
+/**\brief A file loaded by load_many : its tree, or the error that prevented loading it*/
+struct Load_result{
+	BConfig            config; /*!< the tree, empty on error*/
+	std::exception_ptr error;  /*!< what the parse of the file threw (e.g., Error_OpenFile, Error_BConfig_parse), null on success*/
+
+	bool ok()const{return error==nullptr;}
+
+	/**\return config
+	 * \throw error if not ok*/
+	const BConfig &get()const &{if(error){std::rethrow_exception(error);} return config;}
+
+	/**\return config, moved out of this temporary
+	 * \throw error if not ok*/
+	BConfig get()&&{if(error){std::rethrow_exception(error);} return std::move(config);}
 };
 
+/**\brief parse many files concurrently, as BConfig(path,opt) would one at a time.
+ * The files are shared between opt.threads threads (0 = std::thread::hardware_concurrency()) : each thread takes its files in order from its own share,
+ * and takes the last files of another share when its own is done. Each file is parsed sequentially (threads=1), opt.stats is ignored (see set_parse_hook).
+ * On POSIX systems, a thread opens its next file, and asks the system to read it ahead, before it parses the current one.
+ * Small files are then read one after the other into shared 1 MiB buffers : one allocation for many files, released with the last tree that uses them.
+ * \param paths const std::vector<std::string> &. The files to load
+ * \return one result per path, in the order of paths. An error in a file does not stop the others*/
+std::vector<Load_result> load_many(const std::vector<std::string> &paths, const Parse_options &opt=Parse_options());
+
 
 }//end namespace bconfig
 
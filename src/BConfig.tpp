@@ -15,82 +15,132 @@ inline std::ostream & operator<< (std::ostream &out, const bconfig::BConfig & b)
 
 namespace bconfig{
 
-	inline bool BConfig::has_unique_value(const std::string &key)const{
-		auto f = values.find(key);
-		if(f==values.end()){return false;}// key not found
-		return f->second.size()==1;//value is unique
+	template<typename T>
+	inline bool detail::Decoded::get(T &R)const{
+		if constexpr (std::is_same<T,double>::value){
+			if(kind==Kind::floating){R=floating;                  return true;}
+			if(kind==Kind::integer ){R=static_cast<double>(integer);return true;}
+		}else if constexpr (str::is_chars_convertible<T>::value and std::is_integral<T>::value){
+			if(kind!=Kind::integer){return false;}
+			bool in_range;
+			if constexpr (std::is_signed<T>::value){
+				in_range = integer>=static_cast<long long>(std::numeric_limits<T>::min()) and integer<=static_cast<long long>(std::numeric_limits<T>::max());
+			}else{
+				in_range = integer>=0 and static_cast<unsigned long long>(integer)<=std::numeric_limits<T>::max();
+			}
+			if(in_range){R=static_cast<T>(integer);return true;}
+		}
+		return false;
+	}
+
+	namespace detail{
+		//the i-th value of d as T : decoded form if it matches T, conversion of the text otherwise
+		template<typename T>
+		inline T convert_value(const Value_list &d, size_t i){
+			if constexpr (std::is_arithmetic<T>::value){
+				T R;
+				if(i<d.decoded.size() and d.decoded[i].get(R)){return R;}
+			}
+			return bconfig::convert<T>(d.text[i]);
+		}
+	}
+
+
+
+	inline const detail::Value_list *BConfig::find_values(Key key)const{
+		const auto &v = body().values;
+		auto f = v.find(key);
+		if(f==v.end()){return nullptr;}
+		return &f->second;
+	}
+
+	inline bool BConfig::has_unique_value(Key key)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){return false;}// key not found
+		return f->text.size()==1;//value is unique
 	}
 
-	inline bool BConfig::has_values       (const std::string &key)const{
-		auto   f = values.find(key);
-		if(f==values.end()){return false;}// key not found
-		return f->second.size()!=0;       //at least one value
+	inline bool BConfig::has_values       (Key key)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){return false;}// key not found
+		return f->text.size()!=0;       //at least one value
 	}
 
-	inline size_t BConfig::count_values(const std::string &key)const{
-		auto   f = values.find(key);
-		if(f==values.end()){return 0;}// key not found -> 0
-		return f->second.size();     // key found -> size
+	inline size_t BConfig::count_values(Key key)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){return 0;}// key not found -> 0
+		return f->text.size();     // key found -> size
 	}
 
 
 	//generic get
 	template< typename return_t>
-	inline const std::deque<return_t> BConfig::get_values(const std::string &key, bool do_throw)const{
-		std::deque<std::string> s = this->get_values<std::string>(key,do_throw);
+	inline std::deque<return_t> BConfig::get_values(Key key, bool do_throw)const{
 		std::deque<return_t>    r;
-		for(const auto &i:s){return_t rr = bconfig::convert<return_t>(i);r.push_back(rr);}
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){
+			if(do_throw){throw Error_BConfig_get("Missing value",key);}
+			else{return r;}
+		}
+		for(size_t i=0;i<f->text.size();++i){r.push_back(detail::convert_value<return_t>(*f,i));}
 		return r;
 	}
 
 
 	//string get
 	template<>
-	inline const std::deque<std::string> BConfig::get_values(const std::string &key, bool do_throw)const{
-		auto f = values.find(key);
-		if(f==values.end()){
+	inline std::deque<std::string> BConfig::get_values(Key key, bool do_throw)const{
+		const auto &d = get_values_view(key,do_throw);
+		return std::deque<std::string>(d.begin(),d.end());
+	}
+
+
+	//view get
+	inline const std::deque<std::string_view> &BConfig::get_values_view(Key key, bool do_throw)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){
 			if(do_throw){throw Error_BConfig_get("Missing value",key);}
-			else{return empty_values();}
+			else{return empty_values_view();}
 		}
-		return f->second;
+		return f->text;
+	}
+
+	inline const detail::Value_list &BConfig::get_unique_list(Key key)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){throw Error_BConfig_get("Missing value",key);}
+		if(f->text.size()!=1){throw_multiple_values(key,f->text);}
+		return *f;
+	}
+
+	inline std::string_view BConfig::get_value_view(Key key)const{
+		return get_unique_list(key).text[0];
 	}
 
 
 
 	template< typename return_t>
-	inline return_t bconfig::BConfig::get_unique_value(const std::string &key) const{
-		std::string s = get_unique_value<std::string>(key);
-		return bconfig::convert<return_t>(s);
+	inline return_t bconfig::BConfig::get_unique_value(Key key) const{
+		return detail::convert_value<return_t>(get_unique_list(key),0);
 	}
 
 	template< typename return_t>
-	inline return_t bconfig::BConfig::get_unique_value(const std::string &key, const return_t &default_v)const{
-		if(! has_unique_value(key) ){return default_v;}
-		std::string s = get_unique_value<std::string>(key);
-		return bconfig::convert<return_t>(s);
+	inline return_t bconfig::BConfig::get_unique_value(Key key, const return_t &default_v)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr or f->text.size()!=1){return default_v;}
+		return detail::convert_value<return_t>(*f,0);
 	}
 
 	template<>
-	inline std::string bconfig::BConfig::get_unique_value(const std::string &key)const{
-		auto d = get_values<std::string>(key);
-		if(d.size()!=1){
-			std::string vvv;
-			for(const std::string & i : d){vvv +=" " +i;}
-			throw Error_BConfig_get("Multiple values",key,vvv);}
-		return d[0];
+	inline std::string bconfig::BConfig::get_unique_value(Key key)const{
+		return std::string(get_value_view(key));
 	}
 
 	template<>
-	inline std::string bconfig::BConfig::get_unique_value(const std::string &key, const std::string &default_v)const{
-		auto f = values.find(key);
-		if(f==values.end()){return default_v;}
-		const auto &d = f->second;
-		if(d.size()!=1){
-			std::string vvv;
-			for(const std::string & i : d){vvv +=" " +i;}
-			throw Error_BConfig_get("Multiple values", key,vvv);
-		}
-		return d[0];
+	inline std::string bconfig::BConfig::get_unique_value(Key key, const std::string &default_v)const{
+		const detail::Value_list *f = find_values(key);
+		if(f==nullptr){return default_v;}
+		if(f->text.size()!=1){throw_multiple_values(key,f->text);}
+		return std::string(f->text[0]);
 	}
 
 
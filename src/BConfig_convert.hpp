@@ -9,28 +9,38 @@
 #define HELPERS_BCONFIG_CONVERT_HPP_
 
 
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
 #include "BConfig_error.hpp"
+#include "helpers/str_convert.h"
 
 
 //conversion stuff goes here
 namespace bconfig{
 	/**\brief Specialize this struct to define custom conversions from std::string to Target_tt
 	 * The default implementation delegates convertion to operator<<(std::istream&, Target_tt&)
+	 * A specialization may define run(std::string_view) instead of run(const std::string &) to avoid a std::string copy of the value.
 	 * \tparam Target_tt the type to convert to
 	 * \throw Error_BConfig_convert when the conversion is invalid
 	 * */
 	template<typename Target_tt> struct Convert_t{
 		static Target_tt run(const std::string &s){
-			try{
 			Target_tt R;
+			bool ok=false;
+			try{
 			std::stringstream strStream(s);
-			strStream >> R;
-			return R;
+			ok = static_cast<bool>(strStream >> R);
 			}catch(std::exception &e){
 				throw Error_BConfig_convert(std::string("Error in conversion, error=") +  e.what(), s);
 			}catch(...){
 				throw Error_BConfig_convert("Error in conversion", s);
 			}
+			if(!ok){throw Error_BConfig_convert("Error in conversion", s);}
+			return R;
 		}
 	};
 
@@ -38,12 +48,59 @@ namespace bconfig{
 			static const std::string &run(const std::string &s){return s;}
 	};
 
+	template<> struct Convert_t<std::string_view>{
+			static std::string_view run(std::string_view s){return s;}
+	};
+
+
+	namespace detail{
+		/**\brief Conversion of arithmetic types with std::from_chars.
+		 * The whole value must be a number (surrounding white spaces are allowed) : "10abc" is an error, and so is an out of range value.*/
+		template<typename Target_tt> struct Convert_from_chars{
+			static Target_tt run(std::string_view s){
+				Target_tt R;
+				if(!str::fromChars(s,R)){throw Error_BConfig_convert("Error in conversion", std::string(s));}
+				return R;
+			}
+		};
+
+		//true if Convert_t<Target_tt>::run accepts a std::string_view
+		template<typename Target_tt, typename = void> struct Convert_takes_view : std::false_type{};
+		template<typename Target_tt> struct Convert_takes_view<Target_tt,
+			std::void_t<decltype(Convert_t<Target_tt>::run(std::declval<std::string_view>()))>
+		> : std::true_type{};
+	}
+
+	template<> struct Convert_t<short             > : detail::Convert_from_chars<short             >{};
+	template<> struct Convert_t<unsigned short    > : detail::Convert_from_chars<unsigned short    >{};
+	template<> struct Convert_t<int               > : detail::Convert_from_chars<int               >{};
+	template<> struct Convert_t<unsigned int      > : detail::Convert_from_chars<unsigned int      >{};
+	template<> struct Convert_t<long              > : detail::Convert_from_chars<long              >{};
+	template<> struct Convert_t<unsigned long     > : detail::Convert_from_chars<unsigned long     >{};
+	template<> struct Convert_t<long long         > : detail::Convert_from_chars<long long         >{};
+	template<> struct Convert_t<unsigned long long> : detail::Convert_from_chars<unsigned long long>{};
+	template<> struct Convert_t<float             > : detail::Convert_from_chars<float             >{};
+	template<> struct Convert_t<double            > : detail::Convert_from_chars<double            >{};
+	template<> struct Convert_t<long double       > : detail::Convert_from_chars<long double       >{};
+
+
 	/**\brief convert a std::string to Target_tt
 	 * specialize Convert_t to extend this function
 	 * \tparam Target_tt the type to convert to
 	 *
 	 */
 	template<typename Target_tt> Target_tt convert(const std::string &s){return Convert_t<Target_tt>::run(s);}
+
+	/**\brief convert a std::string_view to Target_tt, without copying it when Convert_t<Target_tt>::run accepts a std::string_view
+	 * \tparam Target_tt the type to convert to
+	 */
+	template<typename Target_tt> Target_tt convert(std::string_view s){
+		if constexpr (detail::Convert_takes_view<Target_tt>::value){return Convert_t<Target_tt>::run(s);}
+		else{return Convert_t<Target_tt>::run(std::string(s));}
+	}
+
+	/**\brief convert a C string to Target_tt, see convert(std::string_view)*/
+	template<typename Target_tt> Target_tt convert(const char *s){return convert<Target_tt>(std::string_view(s));}
 }//end namespace bconfig
 
 
@@ -0,0 +1,105 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_counters.hpp
+ * \brief Process wide lookup counters, used to check what BConfig lookups cost, and statistics of each parse.
+ * 		Counters are only updated when BCONFIG_COUNTERS is defined (for the library and for your code),
+ * 		otherwise they compile to nothing, lookup_counters() returns zeros, Parse_options::stats is left untouched and the parse hook is never called.
+ */
+
+#ifndef BCONFIG_COUNTERS_HPP_
+#define BCONFIG_COUNTERS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+
+
+namespace bconfig{
+
+	/**\brief A snapshot of the lookup counters, see lookup_counters()*/
+	struct Lookup_counters{
+		size_t block_lookups =0; /*!< calls that look for blocks by key (get_blocks, get_blocks_view, count_blocks, ...)*/
+		size_t blocks_visited=0; /*!< sub-blocks touched to answer these calls. Equals the number of matching blocks when no scan happens*/
+	};
+
+	namespace detail{
+		struct Lookup_counters_storage{
+			std::atomic<size_t> block_lookups {0};
+			std::atomic<size_t> blocks_visited{0};
+		};
+
+		inline Lookup_counters_storage &lookup_counters_storage(){static Lookup_counters_storage s; return s;}
+	}
+
+	/**\return the current value of the lookup counters (zeros if BCONFIG_COUNTERS is not defined)*/
+	inline Lookup_counters lookup_counters(){
+		const detail::Lookup_counters_storage &s = detail::lookup_counters_storage();
+		Lookup_counters R;
+		R.block_lookups  = s.block_lookups .load(std::memory_order_relaxed);
+		R.blocks_visited = s.blocks_visited.load(std::memory_order_relaxed);
+		return R;
+	}
+
+	/**\brief set all lookup counters to 0*/
+	inline void reset_lookup_counters(){
+		detail::Lookup_counters_storage &s = detail::lookup_counters_storage();
+		s.block_lookups .store(0,std::memory_order_relaxed);
+		s.blocks_visited.store(0,std::memory_order_relaxed);
+	}
+
+
+
+	/**\brief What a parse did and where its time went, see Parse_options::stats and set_parse_hook.
+	 * Blocks parsed later (Parse_options::lazy) are not counted : nodes and values then count the top-level lines only.*/
+	struct Parse_stats{
+		size_t bytes    =0; /*!< size of the input text*/
+		size_t lines    =0; /*!< lines of the input text*/
+		size_t nodes    =0; /*!< blocks created, the root excluded*/
+		size_t values   =0; /*!< values added*/
+		size_t max_depth=0; /*!< deepest block nesting, 0 : no block*/
+
+		std::chrono::nanoseconds io_time      {0}; /*!< reading or mapping the input*/
+		std::chrono::nanoseconds tokenize_time{0}; /*!< splitting lines in keys, values and braces. Summed over threads with Parse_options::threads*/
+		std::chrono::nanoseconds build_time   {0}; /*!< adding values and blocks to the tree. Summed over threads with Parse_options::threads*/
+	};
+
+	typedef std::function<void(const std::string &path, const Parse_stats &)> parse_hook_t;
+
+	namespace detail{
+		struct Parse_hook_storage{
+			std::mutex   m;
+			parse_hook_t f;
+		};
+
+		inline Parse_hook_storage &parse_hook_storage(){static Parse_hook_storage s; return s;}
+	}
+
+	/**\brief call f after each successful parse of the process, from the parsing thread, e.g., to forward Parse_stats to a metrics system.
+	 * An empty f removes the hook. Only called when BCONFIG_COUNTERS is defined.
+	 * f is called without any lock held : it may parse, and it runs on several threads at once when several threads parse, so it must be thread safe.
+	 * A parse running while the hook is replaced may still call the former one.*/
+	inline void set_parse_hook(parse_hook_t f){
+		detail::Parse_hook_storage &s = detail::parse_hook_storage();
+		std::lock_guard<std::mutex> lock(s.m);
+		s.f = std::move(f);
+	}
+
+}//end namespace bconfig
+
+
+#ifdef BCONFIG_COUNTERS
+#define BCONFIG_COUNT(counter,n) (::bconfig::detail::lookup_counters_storage().counter.fetch_add((n),std::memory_order_relaxed))
+#else
+#define BCONFIG_COUNT(counter,n) ((void)0)
+#endif
+
+
+#endif /* BCONFIG_COUNTERS_HPP_ */
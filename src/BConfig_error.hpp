@@ -10,12 +10,19 @@
 
 #include <exception>
 #include <string>
+#include <string_view>
+#include <vector>
 
 
 namespace bconfig{
 /**\brief Base class for BConfig errors, used for catch(Error_BConfig_base &e);.
  * Do not throw this class, use derived instead*/
 struct Error_BConfig_base: std::exception{
+	/**\return error message, with the details of the derived error*/
+	virtual const char* what() const throw(){
+		return msg.c_str();
+	}
+
 	protected:
 
 
@@ -29,13 +36,7 @@ struct Error_BConfig_base: std::exception{
 	/**\brief destructor (do nothing)*/
 	virtual ~Error_BConfig_base() throw(){}
 
-	/**\return error message*/
-	virtual const char* what() const throw(){
-		std::string R=msg;
-		return R.c_str();
-	}
-
-	std::string msg;    /*!<The error message. */
+	std::string msg;    /*!<The error message. Derived errors append their details, so what() can return a pointer into it*/
 	std::string file="";/*!<Optional : the file */
 	size_t line  =0;    /*!<Optional : line number, 0=unknown*/
 	size_t column=0;    /*!<Optional : column number, 0=unknown*/
@@ -54,16 +55,15 @@ struct Error_BConfig_parse: Error_BConfig_base{
 			const std::string& file_ ="",
 			const size_t line_       =0,
 			const size_t column_     =0
-	):Error_BConfig_base(msg_),file(file_),line(line_),column(column_){}
-
-	virtual const char* what() const throw(){
-		std::string R=Error_BConfig_base::what();
-		if(file  !=""){R +=", file="  +file;}
-		if(line  !=0 ){R +=", line="  +std::to_string(line);}
-		if(column!=0 ){R +=", column="+std::to_string(column);}
-		return R.c_str();
+	):Error_BConfig_base(msg_),file(file_),line(line_),column(column_){
+		if(file  !=""){msg +=", file="  +file;}
+		if(line  !=0 ){msg +=", line="  +std::to_string(line);}
+		if(column!=0 ){msg +=", column="+std::to_string(column);}
 	}
 
+	/**\brief append the file that includes file to the message, see Parse_options::include*/
+	void included_from(const std::string &f){msg +=", included from "+f;}
+
 	std::string file  ="";
 	size_t      line  =0;
 	size_t      column=0;
@@ -82,20 +82,12 @@ struct Error_BConfig_get: Error_BConfig_base{
 	*/
 	Error_BConfig_get(
 			const std::string &msg_,
-			const std::string &key_,
-			const std::string &value_=""
-	) throw():Error_BConfig_base(msg_),key(key_),value(value_){}
-
-	/**\param msg_ const std::string&. Error message
-	 * \param key const std::string&. Key used for getting value
-	 * \param value const std::string&. The gotten value
-	 */
-	virtual const char* what() const throw(){
-		std::string R = Error_BConfig_base::what();
-		if(key!=""){R+=", key="+key;}
-		if(value!=""){R+=", value="+value;}
-		return R.c_str();
-	}/*!<\return error message*/
+			std::string_view   key_,
+			std::string_view   value_=""
+	):Error_BConfig_base(msg_),key(key_),value(value_){
+		if(key!=""){msg+=", key="+key;}
+		if(value!=""){msg+=", value="+value;}
+	}
 };
 
 
@@ -109,12 +101,59 @@ struct Error_BConfig_convert: Error_BConfig_base{
 	Error_BConfig_convert(
 			const std::string &msg_,
 			const std::string &from_
-	):Error_BConfig_base(msg_),from(from_){};
+	):Error_BConfig_base(msg_),from(from_){
+		msg+=", from="+from;
+	}
 
-	virtual const char* what() const throw(){
-		std::string R = Error_BConfig_base::what();
-		R+=", from="+from;
-		return R.c_str();
+};
+
+
+/**\brief error thrown when a query path is invalid (see bconfig::Query)*/
+struct Error_BConfig_query: Error_BConfig_base{
+	std::string query;
+	size_t      position;
+
+	/**\param msg_  Error message
+	 * \param query_ The query path
+	 * \param position_ Position of the error in query_
+	 */
+	Error_BConfig_query(
+			const std::string &msg_,
+			std::string_view   query_,
+			size_t             position_
+	):Error_BConfig_base(msg_),query(query_),position(position_){
+		msg+=", query="+query+", position="+std::to_string(position);
+	}
+
+};
+
+
+/**\brief error thrown when a block cannot be bound to a struct (see bconfig::Schema). Lists all the problems found.*/
+struct Error_BConfig_bind: Error_BConfig_base{
+	std::vector<std::string> errors;
+
+	/**\param errors_ One message per problem, prefixed with the path of the key
+	 */
+	explicit Error_BConfig_bind(
+			const std::vector<std::string> &errors_
+	):Error_BConfig_base("Invalid configuration"),errors(errors_){
+		msg+=", "+std::to_string(errors.size())+" errors :";
+		for(const std::string &e : errors){msg+="\n  "+e;}
+	}
+
+};
+
+
+/**\brief error thrown when a tree cannot be written (see BConfig::serialize)*/
+struct Error_BConfig_serialize: Error_BConfig_base{
+	/**\param msg_  Error message
+	 * \param where_ The output (file path or descriptor)
+	 */
+	Error_BConfig_serialize(
+			const std::string &msg_,
+			std::string_view   where_
+	):Error_BConfig_base(msg_){
+		if(!where_.empty()){msg+=", output="+std::string(where_);}
 	}
 
 };
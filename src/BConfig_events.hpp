@@ -0,0 +1,122 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_events.hpp
+ * \brief Event driven parsing : read a configuration file without building a BConfig tree.
+ * 		The parser calls the member functions of a handler, in input order :
+ * 		 - on_value(std::string_view key, std::string_view value)  for key=value
+ * 		 - on_open_block(std::string_view key)                     for key{
+ * 		 - on_close_block()                                        for } that closes a block
+ * 		 - on_empty_block(std::string_view key)                    for key{}
+ * 		The handler is a template parameter : calls are not virtual and can be inlined.
+ * 		Keys and values are trimmed slices of the input text, they are valid as long as the text is.
+ *
+ * 		The syntax and the errors are the ones of BConfig::parse (BConfig is built on this parser) :
+ * 		a } at top-level ends the parse, blocks still open at the end of the text are not closed.
+ */
+
+#ifndef BCONFIG_EVENTS_HPP_
+#define BCONFIG_EVENTS_HPP_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+
+#include "BConfig.hpp"
+
+
+namespace bconfig{
+
+namespace detail{
+	/**\brief A line of configuration text, classified by parse_line. Key and value are trimmed slices of the line.*/
+	struct Line{
+		enum struct Kind{empty, value, open_block, close_block, empty_block}; //empty : blank line or comment
+		Kind             kind=Kind::empty;
+		std::string_view key;
+		std::string_view value;
+	};
+
+	/**\brief classify a line, without its end of line
+	 * \throw Error_BConfig_parse if the line is invalid*/
+	Line parse_line(std::string_view l, const std::string &path, size_t line_num);
+
+	/**\brief consume the next line of text, return it without its end of line*/
+	std::string_view next_line(std::string_view &text);
+
+	/**\brief classify a line as parse_line does, without checking it : 1 opens a block, -1 closes a block, 0 otherwise*/
+	int line_depth_change(std::string_view l);
+
+	/**\brief consume text up to the line that closes the current block (included), or up to the end.
+	 * Lines are not checked, only braces are matched. line_num is incremented for each line.
+	 * \return the consumed text*/
+	std::string_view skip_block(std::string_view &text, size_t &line_num);
+
+	/**\brief instruction sets of find_structurals*/
+	enum struct Scan_level{scalar, sse2, avx2};
+
+	/**\brief the largest text given to find_structurals at once, so that offsets fit in 16 bits*/
+	constexpr size_t scan_chunk = 1<<13;
+
+	/**\return the best Scan_level supported by this build and this cpu, the one used by find_structurals*/
+	Scan_level scan_level();
+
+	/**\brief write the offsets of the structural characters of text (end of line, '=', '{', '}' and '#') in out, in increasing order.
+	 * Blocks of 64 bytes are compared at once with SSE2 or AVX2, chosen at runtime.
+	 * \param n size_t. At most scan_chunk
+	 * \param out uint16_t *. Room for n offsets
+	 * \return the number of offsets*/
+	size_t find_structurals(const char *text, size_t n, uint16_t *out);
+
+	/**\brief same as above, with the instruction set level, or the best one supported if level is not*/
+	size_t find_structurals(const char *text, size_t n, uint16_t *out, Scan_level level);
+
+	/**\brief classify a line as parse_line does, knowing its first structural character and the first # after it (offsets in l, or npos)*/
+	Line scan_line(std::string_view l, size_t first, size_t comment, const std::string &path, size_t line_num);
+
+	/**\brief where a parse cut in pieces is, see parse_events_part*/
+	struct Parse_position{
+		size_t line_num=0; //lines parsed
+		size_t depth   =0; //open blocks
+		bool   ended   =false; //a top-level } ended the parse, the rest of the text is ignored
+	};
+
+	/**\brief call the handler for each line of text, a piece of a larger text cut between lines, and update pos for the next piece.
+	 * Lines are found from the structural characters of find_structurals, scan_chunk bytes at a time. Does nothing if pos.ended.*/
+	template<typename Handler>
+	void parse_events_part(std::string_view text, Handler &h, const std::string &path, Parse_position &pos);
+}
+
+
+/**\brief call the handler for each line of text, see BConfig_events.hpp
+ * \param text std::string_view. The whole configuration text
+ * \param h Handler &. Receives the events
+ * \param path_description const std::string &. Used only for throwing explicit errors
+ * \param line_num size_t. Number of lines before text, used for errors when text is a part of a file
+ * \throw Error_BConfig_parse if text is invalid, or any exception thrown by the handler*/
+template<typename Handler>
+void parse_events(std::string_view text, Handler &h, const std::string &path_description="", size_t line_num=0);
+
+/**\brief read in (until the end) and call the handler, the views are valid until parse_events returns
+ * \throw Error_BConfig_parse if the text is invalid*/
+template<typename Handler>
+void parse_events(std::istream &in, Handler &h, const std::string &path_description="");
+
+/**\brief read the file located at path (mapped if opt.mmap) and call the handler, the views are valid until parse_events returns
+ * \throw Error_OpenFile if the file cannot be opened
+ * \throw Error_BConfig_parse if the file is invalid*/
+template<typename Handler>
+void parse_events_file(const std::string &path, Handler &h, const Parse_options &opt=Parse_options());
+
+}//end namespace bconfig
+
+
+
+//inline & template code
+#include "BConfig_events.tpp"
+
+#endif /* BCONFIG_EVENTS_HPP_ */
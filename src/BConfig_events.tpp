@@ -0,0 +1,268 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include <algorithm>
+
+#include "helpers/str_tools.h"
+
+
+namespace bconfig{
+
+	inline detail::Line detail::parse_line(std::string_view l, const std::string &path, size_t line_num){
+		enum struct Mode{undefined,value,open_blockk, close_blockk,comment,empty_blockk};
+		Mode mode=Mode::undefined;
+
+		Line R;
+		str::trim(l," \t");
+		if(l.empty())return R;
+
+		//current_id and current_value are slices of l
+		size_t id_end=l.size();
+		size_t value_begin=l.size();
+		size_t value_end  =l.size();
+
+		for(size_t i=0; i<l.size(); ++i){
+			char c = l[i];
+			if(c=='#'){
+				if(mode==Mode::undefined){mode=Mode::comment;}
+				if(mode==Mode::value){value_end=i;}
+				goto do_line;
+			}
+
+			if(mode==Mode::undefined){
+				if(c=='='){mode=Mode::value       ;id_end=i;value_begin=i+1;continue;}
+				if(c=='{'){mode=Mode::open_blockk ;id_end=i;continue;}
+				if(c=='}'){mode=Mode::close_blockk;id_end=i;continue;}
+				continue;
+			}
+
+			if(mode==Mode::value)      {continue;}
+
+			if(mode==Mode::open_blockk) {
+				if(c == ' ' or c == '\t'){ continue;}
+				if(c=='}'){mode=Mode::empty_blockk;continue;}
+				throw Error_BConfig_parse("open_blockk" ,path,line_num);
+			}
+
+			if(mode==Mode::close_blockk){
+				if(c == ' ' or c == '\t'){ continue;}
+				throw Error_BConfig_parse("close_blockk",path,line_num);
+			}
+
+			if(mode==Mode::empty_blockk){
+				if(c == ' ' or c == '\t'){ continue;}
+				throw Error_BConfig_parse("empty_blockk",path,line_num);
+			}
+		}//end for char
+
+		do_line:
+
+		if(mode==Mode::comment){return R;} //full line is a comment
+		if(mode==Mode::undefined){throw Error_BConfig_parse("undefined" ,path,line_num);}
+
+		R.key   = l.substr(0,id_end);
+		R.value = l.substr(value_begin,value_end-value_begin);
+		str::trim(R.value," \t");
+		str::trim(R.key," \t");
+
+		switch(mode){
+			case Mode::value        : R.kind=Line::Kind::value      ; break;
+			case Mode::open_blockk  : R.kind=Line::Kind::open_block ; break;
+			case Mode::close_blockk : R.kind=Line::Kind::close_block; break;
+			case Mode::empty_blockk : R.kind=Line::Kind::empty_block; break;
+			default : break;
+		}
+		return R;
+	}
+
+
+
+	inline std::string_view detail::next_line(std::string_view &text){
+		size_t eol = text.find('\n');
+		std::string_view l = text.substr(0,eol);
+		text.remove_prefix( eol==std::string_view::npos ? text.size() : eol+1 );
+		return l;
+	}
+
+
+
+	inline int detail::line_depth_change(std::string_view l){
+		for(size_t i=0; i<l.size(); ++i){
+			char c = l[i];
+			if(c=='#' or c=='='){return 0;}
+			if(c=='}'){return -1;}
+			if(c=='{'){
+				for(++i; i<l.size(); ++i){
+					if(l[i]==' ' or l[i]=='\t'){continue;}
+					return l[i]=='}' ? 0 : 1;
+				}
+				return 1;
+			}
+		}
+		return 0;
+	}
+
+
+
+	inline std::string_view detail::skip_block(std::string_view &text, size_t &line_num){
+		const char *begin = text.data();
+		size_t depth=0;
+		while(!text.empty()){
+			int d = line_depth_change(next_line(text));
+			++line_num;
+			if(d>0){++depth;}
+			if(d<0){
+				if(depth==0){break;}
+				--depth;
+			}
+		}
+		return std::string_view(begin,static_cast<size_t>(text.data()-begin));
+	}
+
+
+
+	namespace detail{
+		//str::trim(s," \t"), without the generic character set lookup
+		inline void trim_blanks(std::string_view &s){
+			size_t b=0, e=s.size();
+			while(b<e and (s[b]==' ' or s[b]=='\t')){++b;}
+			while(e>b and (s[e-1]==' ' or s[e-1]=='\t')){--e;}
+			s = s.substr(b,e-b);
+		}
+	}
+
+
+
+	inline detail::Line detail::scan_line(std::string_view l, size_t first, size_t comment, const std::string &path, size_t line_num){
+		if(first==std::string_view::npos){return parse_line(l,path,line_num);} //blank or invalid
+		if(l[first]=='#'){return Line();}
+
+		Line R;
+		R.key = l.substr(0,first);
+		trim_blanks(R.key);
+
+		//key = value # comment
+		if(l[first]=='='){
+			R.kind  = Line::Kind::value;
+			R.value = comment==std::string_view::npos ? l.substr(first+1) : l.substr(first+1,comment-first-1);
+			trim_blanks(R.value);
+			return R;
+		}
+
+		//key {   key { }   } : only blanks or a comment may follow
+		size_t i=first+1;
+		auto skip_blanks = [&](){while(i<l.size() and (l[i]==' ' or l[i]=='\t')){++i;}};
+		skip_blanks();
+		if(l[first]=='}'){
+			R.kind = Line::Kind::close_block;
+		}else if(i<l.size() and l[i]=='}'){
+			R.kind = Line::Kind::empty_block;
+			++i;
+			skip_blanks();
+		}else{
+			R.kind = Line::Kind::open_block;
+		}
+		if(i<l.size() and l[i]!='#'){return parse_line(l,path,line_num);} //throws the error
+		return R;
+	}
+
+
+
+	template<typename Handler>
+	inline void detail::parse_events_part(std::string_view text, Handler &h, const std::string &path, Parse_position &pos){
+		if(pos.ended){return;}
+		const size_t npos = std::string_view::npos;
+		size_t line_num = pos.line_num;
+		size_t depth    = pos.depth; //open blocks
+
+		//false if the line ends the parse
+		auto on_line = [&](const detail::Line &line){
+			switch(line.kind){
+				case detail::Line::Kind::empty       : break;
+				case detail::Line::Kind::value       : h.on_value(line.key,line.value); break;
+				case detail::Line::Kind::open_block  : ++depth; h.on_open_block(line.key); break;
+				case detail::Line::Kind::empty_block : h.on_empty_block(line.key); break;
+				case detail::Line::Kind::close_block :
+					if(depth==0){pos.ended=true; return false;} //closes the top-level, the rest of the text is ignored
+					--depth;
+					h.on_close_block();
+					break;
+			}
+			return true;
+		};
+
+		uint16_t index[scan_chunk];
+		while(!text.empty()){
+			const size_t n     = std::min(text.size(),scan_chunk);
+			const size_t count = find_structurals(text.data(),n,index);
+
+			size_t begin   = 0;    //current line
+			size_t first   = npos; //its first structural character
+			size_t comment = npos; //its first # after first
+			for(size_t i=0; i<count; ++i){
+				const size_t p = index[i];
+				if(text[p]!='\n'){
+					if(first==npos){first=p;}
+					else if(comment==npos and text[p]=='#'){comment=p;}
+					continue;
+				}
+
+				++line_num;
+				std::string_view l = text.substr(begin,p-begin);
+				if(!on_line(scan_line(l, first==npos ? npos : first-begin, comment==npos ? npos : comment-begin, path, line_num))){return;}
+				begin = p+1;
+				first = comment = npos;
+			}
+
+			if(n==text.size()){ //the last line, without end of line
+				if(begin<n){
+					++line_num;
+					std::string_view l = text.substr(begin);
+					if(!on_line(scan_line(l, first==npos ? npos : first-begin, comment==npos ? npos : comment-begin, path, line_num))){return;}
+				}
+				break;
+			}
+
+			if(begin==0){ //a line longer than scan_chunk
+				std::string_view l = detail::next_line(text);
+				++line_num;
+				if(!on_line(detail::parse_line(l,path,line_num))){return;}
+				continue;
+			}
+			text.remove_prefix(begin); //the cut line is scanned again with the next chunk
+		}
+
+		pos.line_num = line_num;
+		pos.depth    = depth;
+	}
+
+
+
+	template<typename Handler>
+	inline void parse_events(std::string_view text, Handler &h, const std::string &path, size_t line_num){
+		detail::Parse_position pos;
+		pos.line_num = line_num;
+		detail::parse_events_part(text,h,path,pos);
+	}
+
+
+
+	template<typename Handler>
+	inline void parse_events(std::istream &in, Handler &h, const std::string &path_description){
+		detail::Text t = detail::read_text(in);
+		parse_events(t.text,h,path_description);
+	}
+
+
+
+	template<typename Handler>
+	inline void parse_events_file(const std::string &path, Handler &h, const Parse_options &opt){
+		detail::Text t = detail::load_text(path,opt);
+		parse_events(t.text,h,path);
+	}
+
+}//end namespace bconfig
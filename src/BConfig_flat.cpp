@@ -0,0 +1,362 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include "BConfig_flat.hpp"
+#include "helpers/MappedFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+
+using namespace bconfig;
+
+
+
+namespace bconfig{ namespace detail{
+
+//build a flat image from a BConfig, and a BConfig from a flat image
+struct Flat_builder{
+	typedef flat_format::Header Header;
+	typedef flat_format::Node   Node;
+	typedef flat_format::Key    Key;
+	typedef flat_format::Child  Child;
+	typedef flat_format::Str    Str;
+
+	std::vector<Node>     nodes;
+	std::vector<Key>      keys;
+	std::vector<Str>      values;
+	std::vector<Child>    children;
+	std::vector<uint32_t> children_index;
+	std::string           strings;
+	std::unordered_map<std::string_view, Str> interned; //views into the BConfig text
+
+	Str intern(std::string_view s){
+		auto f = interned.find(s);
+		if(f!=interned.end()){return f->second;}
+		if(strings.size()+s.size() > std::numeric_limits<uint32_t>::max()){throw std::length_error("BConfig_flat : string table too large");}
+		Str R{static_cast<uint32_t>(strings.size()),static_cast<uint32_t>(s.size())};
+		strings.append(s);
+		interned.emplace(s,R);
+		return R;
+	}
+
+	std::string_view str(Str s)const{return std::string_view(strings.data()+s.offset,s.size);}
+
+	//write b as node n, its sub-blocks get the next node numbers (depth first), so a child is always after its parent
+	void write(const BConfig &lazy_b, uint32_t n){
+		const BConfig &b = lazy_b.body();
+
+		//keys, sorted for binary search. Values of a key stay in input order
+		const size_t keys_begin = keys.size();
+		for(const auto &v : b.values){
+			Key k;
+			k.key          = intern(v.first);
+			k.values_begin = static_cast<uint32_t>(values.size());
+			for(std::string_view s : v.second.text){values.push_back(intern(s));}
+			k.values_end   = static_cast<uint32_t>(values.size());
+			keys.push_back(k);
+		}
+		std::sort(keys.begin()+keys_begin, keys.end(), [this](const Key &a, const Key &c){return str(a.key)<str(c.key);});
+		nodes[n].keys_begin = static_cast<uint32_t>(keys_begin);
+		nodes[n].keys_end   = static_cast<uint32_t>(keys.size());
+
+		//children : reserve the range first so it is contiguous, index it by key, then recurse
+		const uint32_t children_begin = static_cast<uint32_t>(children.size());
+		children.resize(children.size()+b.blocks.size());
+		children_index.resize(children.size());
+		nodes[n].children_begin = children_begin;
+		nodes[n].children_end   = static_cast<uint32_t>(children.size());
+
+		uint32_t i = children_begin;
+		for(const auto &c : b.blocks){
+			children[i].key      = intern(c.first);
+			children[i].reserved = 0;
+			children_index[i]    = i;
+			++i;
+		}
+		std::stable_sort(children_index.begin()+children_begin, children_index.end(),
+			[this](uint32_t a, uint32_t c){return str(children[a].key)<str(children[c].key);});
+
+		i = children_begin;
+		for(const auto &c : b.blocks){
+			if(nodes.size() >= std::numeric_limits<uint32_t>::max()){throw std::length_error("BConfig_flat : too many blocks");}
+			const uint32_t child_node = static_cast<uint32_t>(nodes.size());
+			nodes.emplace_back();
+			children[i++].node = child_node;
+			write(c.second,child_node);
+		}
+	}
+
+	static uint64_t align(uint64_t s){return (s+7)/8*8;}
+
+	template<typename T>
+	static void copy_section(char *image, uint64_t offset, const std::vector<T> &v){
+		if(!v.empty()){std::memcpy(image+offset,v.data(),v.size()*sizeof(T));}
+	}
+
+	std::shared_ptr<const Flat_tree> run(const BConfig &b){
+		nodes.emplace_back();
+		write(b,0);
+		if(values.size() > std::numeric_limits<uint32_t>::max() or keys.size() > std::numeric_limits<uint32_t>::max()){
+			throw std::length_error("BConfig_flat : too many records");
+		}
+
+		Header h;
+		std::memset(&h,0,sizeof(h));
+		std::memcpy(h.magic,flat_format::magic,sizeof(h.magic));
+		h.version    = flat_format::version;
+		h.byte_order = flat_format::byte_order;
+		h.nodes_size    = static_cast<uint32_t>(nodes.size());
+		h.keys_size     = static_cast<uint32_t>(keys.size());
+		h.values_size   = static_cast<uint32_t>(values.size());
+		h.children_size = static_cast<uint32_t>(children.size());
+		h.strings_size  = strings.size();
+
+		uint64_t p = align(sizeof(Header));
+		h.nodes_offset          = p; p = align(p+nodes.size()         *sizeof(Node));
+		h.keys_offset           = p; p = align(p+keys.size()          *sizeof(Key));
+		h.values_offset         = p; p = align(p+values.size()        *sizeof(Str));
+		h.children_offset       = p; p = align(p+children.size()      *sizeof(Child));
+		h.children_index_offset = p; p = align(p+children_index.size()*sizeof(uint32_t));
+		h.strings_offset        = p; p = p+strings.size();
+		h.image_size            = p;
+
+		//one 8 bytes aligned buffer, zero filled so the padding is deterministic
+		auto buffer = std::make_shared<std::vector<uint64_t> >((p+7)/8,0);
+		char *image = reinterpret_cast<char*>(buffer->data());
+		std::memcpy(image,&h,sizeof(h));
+		copy_section(image,h.nodes_offset,nodes);
+		copy_section(image,h.keys_offset,keys);
+		copy_section(image,h.values_offset,values);
+		copy_section(image,h.children_offset,children);
+		copy_section(image,h.children_index_offset,children_index);
+		if(!strings.empty()){std::memcpy(image+h.strings_offset,strings.data(),strings.size());}
+
+		return std::make_shared<const Flat_tree>(image,static_cast<size_t>(p),std::move(buffer),"");
+	}
+
+	//fill b with node n of t, keys and values point into the image, that b.storage keeps alive
+	static void unflatten(const Flat_tree &t, uint32_t n, BConfig &b){
+		const Node &node = t.nodes[n];
+		for(uint32_t k = node.keys_begin; k<node.keys_end; ++k){
+			const Key &key = t.keys[k];
+			for(uint32_t v = key.values_begin; v<key.values_end; ++v){b.add_value(t.str(key.key),t.str(t.values[v]),false);}
+		}
+		for(uint32_t i = node.children_begin; i<node.children_end; ++i){
+			const Child &c = t.children[i];
+			unflatten(t,c.node,b.add_block(t.str(c.key)));
+		}
+	}
+};
+
+
+
+Flat_tree::Flat_tree(const char *image, size_t size, std::shared_ptr<const void> owner_, const std::string &path_description):owner(std::move(owner_)){
+	auto invalid = [&path_description](const char *what){return Error_BConfig_parse(std::string("invalid binary file : ")+what,path_description);};
+
+	if(size<sizeof(flat_format::Header) or reinterpret_cast<uintptr_t>(image)%8!=0){throw invalid("truncated header");}
+	header = reinterpret_cast<const flat_format::Header*>(image);
+	const flat_format::Header &h = *header;
+	if(std::memcmp(h.magic,flat_format::magic,sizeof(h.magic))!=0){throw invalid("bad magic");}
+	if(h.version   !=flat_format::version   ){throw invalid("unsupported version");}
+	if(h.byte_order!=flat_format::byte_order){throw invalid("unsupported byte order");}
+	if(h.image_size!=size                   ){throw invalid("bad size");}
+	if(h.nodes_size==0                      ){throw invalid("no root");}
+
+	auto section = [&](uint64_t offset, uint64_t n, size_t record){
+		if(offset%8!=0 or offset>size or n > (size-offset)/record){throw invalid("section out of bounds");}
+		return image+offset;
+	};
+	nodes          = reinterpret_cast<const Node*    >(section(h.nodes_offset,h.nodes_size,sizeof(Node)));
+	keys           = reinterpret_cast<const Key*     >(section(h.keys_offset,h.keys_size,sizeof(Key)));
+	values         = reinterpret_cast<const Str*     >(section(h.values_offset,h.values_size,sizeof(Str)));
+	children       = reinterpret_cast<const Child*   >(section(h.children_offset,h.children_size,sizeof(Child)));
+	children_index = reinterpret_cast<const uint32_t*>(section(h.children_index_offset,h.children_size,sizeof(uint32_t)));
+	strings        = section(h.strings_offset,h.strings_size,1);
+
+	//records : one sequential pass, so that a corrupted file cannot make a getter read out of the image or loop
+	auto check_str = [&](Str s){if(s.offset>h.strings_size or s.size>h.strings_size-s.offset){throw invalid("string out of bounds");}};
+	auto check_range = [&](uint32_t b, uint32_t e, uint32_t n){if(b>e or e>n){throw invalid("range out of bounds");}};
+
+	for(uint32_t k=0;k<h.keys_size;++k){
+		check_str(keys[k].key);
+		check_range(keys[k].values_begin,keys[k].values_end,h.values_size);
+	}
+	for(uint32_t v=0;v<h.values_size;++v){check_str(values[v]);}
+	for(uint32_t c=0;c<h.children_size;++c){check_str(children[c].key);}
+
+	//a node has one parent at most : shared subtrees would make a walk of the tree exponential in its depth.
+	//keys and children_index are sorted, as find_key and find_children search them by bisection
+	std::vector<bool> has_parent(h.nodes_size,false);
+	for(uint32_t n=0;n<h.nodes_size;++n){
+		const Node &node = nodes[n];
+		check_range(node.keys_begin,node.keys_end,h.keys_size);
+		check_range(node.children_begin,node.children_end,h.children_size);
+		for(uint32_t k = node.keys_begin+1; k<node.keys_end; ++k){
+			if(!(str(keys[k-1].key)<str(keys[k].key))){throw invalid("keys not sorted");}
+		}
+		for(uint32_t i = node.children_begin; i<node.children_end; ++i){
+			const uint32_t c = children[i].node;
+			if(c<=n or c>=h.nodes_size){throw invalid("bad child node");}
+			if(has_parent[c]){throw invalid("node with several parents");}
+			has_parent[c] = true;
+			if(children_index[i]<node.children_begin or children_index[i]>=node.children_end){throw invalid("bad children index");}
+			if(i>node.children_begin){
+				//by key, then by position : each child is indexed once
+				const uint32_t a = children_index[i-1], b = children_index[i];
+				const std::string_view ka = str(children[a].key), kb = str(children[b].key);
+				if(!(ka<kb or (ka==kb and a<b))){throw invalid("children index not sorted");}
+			}
+		}
+	}
+}
+
+
+
+const Flat_tree::Key* Flat_tree::find_key(uint32_t n, std::string_view key)const{
+	const Node &node = nodes[n];
+	const Key *b = keys+node.keys_begin;
+	const Key *e = keys+node.keys_end;
+	const Key *f = std::lower_bound(b,e,key,[this](const Key &k, std::string_view s){return str(k.key)<s;});
+	if(f==e or str(f->key)!=key){return nullptr;}
+	return f;
+}
+
+
+
+void Flat_tree::find_children(uint32_t n, std::string_view key, const uint32_t *&begin, const uint32_t *&end)const{
+	const Node &node = nodes[n];
+	struct Less{
+		const Flat_tree *t;
+		bool operator()(uint32_t i, std::string_view s)const{return t->str(t->children[i].key)<s;}
+		bool operator()(std::string_view s, uint32_t i)const{return s<t->str(t->children[i].key);}
+	};
+	auto r = std::equal_range(children_index+node.children_begin, children_index+node.children_end, key, Less{this});
+	begin = r.first;
+	end   = r.second;
+}
+
+}}//end namespace bconfig::detail
+
+
+
+
+BConfig_flat::BConfig_flat(const BConfig &b):tree(detail::Flat_builder().run(b)),node(0){}
+
+
+
+void BConfig_flat::save_binary(const std::string &path)const{
+	std::shared_ptr<const detail::Flat_tree> t = tree ? tree : BConfig_flat(BConfig()).tree;
+	std::ofstream out(path,std::ios::binary|std::ios::trunc);
+	if(!out){throw Error_OpenFile(path);}
+	out.write(reinterpret_cast<const char*>(t->header),static_cast<std::streamsize>(t->header->image_size));
+	out.close();
+	if(!out){throw Error_OpenFile(path);}
+}
+
+
+
+BConfig_flat BConfig_flat::load_binary(const std::string &path){
+	auto file = std::make_shared<const MappedFile>(path);
+	auto t    = std::make_shared<const detail::Flat_tree>(file->data(),file->size(),file,path);
+	return BConfig_flat(std::move(t),0);
+}
+
+
+
+void BConfig::save_binary(const std::string &path)const{
+	BConfig_flat(*this).save_binary(path);
+}
+
+
+
+BConfig BConfig::load_binary(const std::string &path){
+	auto file = std::make_shared<const MappedFile>(path);
+	detail::Flat_tree t(file->data(),file->size(),file,path);
+
+	BConfig R;
+	R.storage = std::make_shared<detail::Text_storage>();
+	R.storage->add(file,file->view());
+	detail::Flat_builder::unflatten(t,0,R);
+	return R;
+}
+
+
+
+std::deque<BConfig_flat> BConfig_flat::get_blocks(std::string_view key, bool throw_b)const{
+	Block_range d = get_blocks_view(key,throw_b);
+	return std::deque<BConfig_flat>(d.begin(),d.end());
+}
+
+
+
+BConfig_flat::Block_range BConfig_flat::get_blocks_view(std::string_view key, bool throw_b)const{
+	const uint32_t *b=nullptr, *e=nullptr;
+	if(tree){tree->find_children(node,key,b,e);}
+	if(b==e and throw_b){throw Error_BConfig_get("Missing block", key);}
+	return Block_range(tree.get(),b,e);
+}
+
+
+
+BConfig_flat BConfig_flat::get_unique_block(std::string_view key)const{
+	Block_range d = get_blocks_view(key,true);
+	if(d.size()!=1){throw Error_BConfig_get("Multiple blocks", key);}
+	return d[0];
+}
+
+
+
+size_t BConfig_flat::count_blocks(std::string_view key)const{
+	return get_blocks_view(key,false).size();
+}
+
+
+bool BConfig_flat::get_yes_no(std::string_view key)const{
+	std::string_view s=get_value_view(key);
+	if(s=="y" or s== "yes"){return true;}
+	if(s=="n" or s== "no"){return false;}
+	throw Error_BConfig_get("get_yes_no : invalid string", key,std::string(s));
+}
+
+
+bool BConfig_flat::get_yes_no(std::string_view key,bool default_v)const{
+	auto d = get_values_view(key,false);
+	if(d.empty()){return default_v;}
+	if(d.size()!=1){throw Error_BConfig_get("Multiple values", key);}
+	std::string_view s = d[0];
+	if(s=="")return default_v;
+	if(s=="y" or s== "yes"){return true;}
+	if(s=="n" or s== "no"){return false;}
+	throw Error_BConfig_get("get_yes_no : invalid string", key,std::string(s));
+}
+
+
+void BConfig_flat::print(std::ostream &out, size_t indent_v)const{
+	if(!tree){return;}
+	auto indent = [&out](size_t s){for(size_t i = 0;i<s;++i){out << "  ";}};
+
+	const detail::Flat_tree::Node &n = tree->nodes[node];
+	for(uint32_t k = n.keys_begin; k<n.keys_end; ++k){
+		const detail::Flat_tree::Key &key = tree->keys[k];
+		indent(indent_v);
+		for(uint32_t v = key.values_begin; v<key.values_end; ++v){out <<tree->str(key.key)<<"="<< tree->str(tree->values[v]) <<"\n";}
+	}
+
+	for(uint32_t i = n.children_begin; i<n.children_end; ++i){
+		const detail::Flat_tree::Child &c = tree->children[i];
+		indent(indent_v);
+		out << tree->str(c.key) <<"{\n";
+		BConfig_flat(tree,c.node).print(out,indent_v+1);
+		indent(indent_v);
+		out<<"}\n";
+	}
+}
@@ -0,0 +1,308 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_flat.hpp
+ * \brief An alternative, read only, storage engine for BConfig.
+ * 		The whole tree lives in a single image : a header, a few contiguous arrays (nodes, keys, values, children, children index)
+ * 		and a string table. Records refer to each other and to the string table with offsets, never with pointers,
+ * 		so the image is also the binary file format : BConfig_flat::save_binary writes it, BConfig_flat::load_binary maps it.
+ * 		A BConfig_flat is a lightweight handle (image + node index) : copies and sub-blocks are cheap.
+ * 		The getters are the same as BConfig.
+ */
+
+#ifndef BCONFIG_FLAT_HPP_
+#define BCONFIG_FLAT_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "BConfig.hpp"
+
+
+namespace bconfig{
+
+namespace detail{
+
+	/**\brief Layout of a flat image, and of the binary file format.
+	 * All integers are in native byte order (checked with Header::byte_order), sections are 8 bytes aligned.*/
+	namespace flat_format{
+		const char     magic[8]   = {'B','C','o','n','f','i','g','\0'};
+		const uint32_t version    = 1;
+		const uint32_t byte_order = 0x01020304;
+
+		struct Header{
+			char     magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+			uint32_t nodes_size, keys_size, values_size, children_size;
+			uint64_t nodes_offset, keys_offset, values_offset, children_offset, children_index_offset, strings_offset;
+			uint64_t strings_size;
+			uint64_t image_size;
+		};
+
+		/**\brief a string, as a slice of the string table*/
+		struct Str{
+			uint32_t offset, size;
+		};
+
+		struct Node {
+			uint32_t keys_begin, keys_end;         //range in keys, sorted by key
+			uint32_t children_begin, children_end; //range in children (input order), and in children_index (sorted by key, then input order)
+		};
+
+		struct Key {
+			Str      key;
+			uint32_t values_begin, values_end; //range in values, in input order
+		};
+
+		struct Child {
+			Str      key;
+			uint32_t node;
+			uint32_t reserved;
+		};
+	}
+
+
+	/**\brief A flat image in memory, owned or mapped. Node 0 is the root.*/
+	struct Flat_tree : std::enable_shared_from_this<Flat_tree>{
+		typedef flat_format::Node  Node;
+		typedef flat_format::Key   Key;
+		typedef flat_format::Child Child;
+		typedef flat_format::Str   Str;
+
+		const flat_format::Header *header        =nullptr;
+		const Node                *nodes         =nullptr;
+		const Key                 *keys          =nullptr;
+		const Str                 *values        =nullptr;
+		const Child               *children      =nullptr;
+		const uint32_t            *children_index=nullptr; //positions in children
+		const char                *strings       =nullptr;
+
+		std::shared_ptr<const void> owner; //owns the image : a buffer or a file mapping
+
+		/**\brief point the arrays into image
+		 * \throw Error_BConfig_parse if the header or the section bounds are invalid*/
+		Flat_tree(const char *image, size_t size, std::shared_ptr<const void> owner_, const std::string &path_description);
+
+		std::string_view str(Str s)const{return std::string_view(strings+s.offset,s.size);}
+
+		const Key* find_key(uint32_t node, std::string_view key)const;
+
+		//range in children_index of the children of node with key
+		void find_children(uint32_t node, std::string_view key, const uint32_t *&begin, const uint32_t *&end)const;
+	};
+
+}//end namespace detail
+
+
+
+
+/**\brief A read only BConfig stored in a flat image, see BConfig_flat.hpp
+ */
+struct BConfig_flat{
+
+	struct Value_range;
+	struct Block_range;
+
+	BConfig_flat()                    =default;/*!<\brief construct an empty BConfig_flat.*/
+	BConfig_flat(const BConfig_flat &)=default;/*!<\brief default copy constructor, cheap : the image is shared.*/
+	~BConfig_flat()                   =default;/*!<\brief default destructor*/
+
+	/**\brief flatten an already parsed BConfig. Keys and values are copied in the string table of the image (each distinct string once).*/
+	explicit BConfig_flat(const BConfig &b);
+
+	/** \brief Load a file located at path, see BConfig::parse for detail
+	 * \param path const std::string &. Input file path
+	 * \param opt const Parse_options &. How to read the file*/
+	explicit BConfig_flat(const std::string &path, const Parse_options &opt=Parse_options()):BConfig_flat(BConfig(path,opt)){}
+
+	/**\brief load from std::istream, see BConfig::parse for detail*/
+	explicit BConfig_flat(std::istream &in,const std::string &path_description="" ):BConfig_flat(BConfig(in,path_description)){}
+
+
+	/**\brief write the image in a binary file, that BConfig_flat::load_binary and BConfig::load_binary can read.
+	 * \throw Error_OpenFile if the file cannot be written*/
+	void save_binary(const std::string &path)const;
+
+	/**\brief map a binary file written by save_binary. Nothing is parsed : the arrays point into the read only mapping,
+	 * which is shared between all the processes that load the same file.
+	 * The file must not be modified while a BConfig_flat loaded from it is alive.
+	 * \throw Error_OpenFile if the file cannot be opened
+	 * \throw Error_BConfig_parse if the file is not a binary BConfig file, or has another version or byte order*/
+	static BConfig_flat load_binary(const std::string &path);
+
+
+	/**\return true if exactly one value for key, false otherwise*/
+	bool has_unique_value(std::string_view key)const;
+
+	/**\return true if one or more value for key, false if no value for key*/
+	bool has_values       (std::string_view key)const;
+
+	/**\return the number of values for the key*/
+	size_t count_values(std::string_view key)const;
+
+	/**\brief see BConfig::get_values*/
+	template< typename return_t = std::string>
+	std::deque<return_t> get_values(std::string_view key,bool do_throw=true)const;
+
+	/**\brief see BConfig::get_values_view. Valid as long as a BConfig_flat of this image is alive.*/
+	Value_range get_values_view(std::string_view key,bool do_throw=true)const;
+
+	/**\brief see BConfig::get_value_view*/
+	std::string_view get_value_view(std::string_view key)const;
+
+	/**\brief see BConfig::get_unique_value*/
+	template< typename return_t = std::string>
+	return_t get_unique_value(std::string_view key) const{return bconfig::convert<return_t>(get_value_view(key));}
+
+	/**\brief see BConfig::get_unique_value*/
+	template< typename return_t = std::string>
+	return_t get_unique_value(std::string_view key, const return_t &default_v)const;
+
+	/**\brief see BConfig::get_blocks, returned blocks are handles on this image (no copy)*/
+	std::deque<BConfig_flat> get_blocks (std::string_view key, bool throw_b=true)const;
+
+	/**\brief see BConfig::get_blocks_view. A range of BConfig_flat handles, valid as long as a BConfig_flat of this image is alive.*/
+	Block_range get_blocks_view(std::string_view key, bool throw_b=true)const;
+
+	/**\brief see BConfig::get_unique_block*/
+	BConfig_flat get_unique_block(std::string_view key)const;
+
+	/**\brief see BConfig::count_blocks*/
+	size_t count_blocks(std::string_view key)const;
+
+	/**\brief see BConfig::get_yes_no*/
+	bool get_yes_no(std::string_view key)const;
+
+	/**\brief see BConfig::get_yes_no*/
+	bool get_yes_no(std::string_view key,bool default_v)const;
+
+	/**\brief see BConfig::print. Keys are printed in sorted order.*/
+	void print(std::ostream &out, size_t indent_v=0)const;
+
+
+private:
+	friend struct detail::Flat_builder;
+
+	BConfig_flat(std::shared_ptr<const detail::Flat_tree> tree_, uint32_t node_):tree(std::move(tree_)),node(node_){}
+
+	std::shared_ptr<const detail::Flat_tree> tree; //null for an empty BConfig_flat
+	uint32_t node=0;
+};
+
+
+
+/**\brief The values of a key, see BConfig_flat::get_values_view. A random access range of std::string_view.*/
+struct BConfig_flat::Value_range{
+	struct iterator{
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef std::string_view                value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef const std::string_view*         pointer;
+		typedef std::string_view                reference;
+
+		iterator()=default;
+		iterator(const detail::Flat_tree *tree_, const detail::flat_format::Str *i_):tree(tree_),i(i_){}
+
+		reference operator* ()const{return tree->str(*i);}
+		reference operator[](difference_type n)const{return tree->str(i[n]);}
+
+		iterator &operator++()     {++i;return *this;}
+		iterator  operator++(int)  {iterator r=*this; ++i; return r;}
+		iterator &operator--()     {--i;return *this;}
+		iterator  operator--(int)  {iterator r=*this; --i; return r;}
+		iterator &operator+=(difference_type n){i+=n;return *this;}
+		iterator &operator-=(difference_type n){i-=n;return *this;}
+		iterator  operator+ (difference_type n)const{return iterator(tree,i+n);}
+		iterator  operator- (difference_type n)const{return iterator(tree,i-n);}
+		difference_type operator-(const iterator &o)const{return i-o.i;}
+
+		bool operator==(const iterator &o)const{return i==o.i;}
+		bool operator!=(const iterator &o)const{return i!=o.i;}
+		bool operator< (const iterator &o)const{return i< o.i;}
+
+	private:
+		const detail::Flat_tree        *tree=nullptr;
+		const detail::flat_format::Str *i   =nullptr;
+	};
+
+	Value_range()=default;
+	Value_range(const detail::Flat_tree *tree, const detail::flat_format::Str *begin_, const detail::flat_format::Str *end_):b(tree,begin_),e(tree,end_){}
+
+	iterator begin()const{return b;}
+	iterator end  ()const{return e;}
+	bool     empty()const{return b==e;}
+	size_t   size ()const{return static_cast<size_t>(e-b);}
+	std::string_view operator[](size_t n)const{return b[static_cast<std::ptrdiff_t>(n)];}
+
+private:
+	iterator b, e;
+};
+
+
+
+/**\brief The sub-blocks of a BConfig_flat that have the same key, see BConfig_flat::get_blocks_view.
+ * A random access range of BConfig_flat handles, in input order.*/
+struct BConfig_flat::Block_range{
+	struct iterator{
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef BConfig_flat                    value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef const BConfig_flat*             pointer;
+		typedef BConfig_flat                    reference;
+
+		iterator()=default;
+		iterator(const detail::Flat_tree *tree_, const uint32_t *i_):tree(tree_),i(i_){}
+
+		reference operator* ()const{return (*this)[0];}
+		reference operator[](difference_type n)const{return BConfig_flat(tree->shared_from_this(),tree->children[i[n]].node);}
+
+		iterator &operator++()     {++i;return *this;}
+		iterator  operator++(int)  {iterator r=*this; ++i; return r;}
+		iterator &operator--()     {--i;return *this;}
+		iterator  operator--(int)  {iterator r=*this; --i; return r;}
+		iterator &operator+=(difference_type n){i+=n;return *this;}
+		iterator &operator-=(difference_type n){i-=n;return *this;}
+		iterator  operator+ (difference_type n)const{return iterator(tree,i+n);}
+		iterator  operator- (difference_type n)const{return iterator(tree,i-n);}
+		difference_type operator-(const iterator &o)const{return i-o.i;}
+
+		bool operator==(const iterator &o)const{return i==o.i;}
+		bool operator!=(const iterator &o)const{return i!=o.i;}
+		bool operator< (const iterator &o)const{return i< o.i;}
+
+	private:
+		const detail::Flat_tree *tree=nullptr;
+		const uint32_t          *i   =nullptr;
+	};
+
+	Block_range()=default;
+	Block_range(const detail::Flat_tree *tree, const uint32_t *begin_, const uint32_t *end_):b(tree,begin_),e(tree,end_){}
+
+	iterator begin()const{return b;}
+	iterator end  ()const{return e;}
+	bool     empty()const{return b==e;}
+	size_t   size ()const{return static_cast<size_t>(e-b);}
+	BConfig_flat operator[](size_t n)const{return b[static_cast<std::ptrdiff_t>(n)];}
+
+private:
+	iterator b, e;
+};
+
+
+}//end namespace bconfig
+
+
+
+//inline & template code
+#include "BConfig_flat.tpp"
+
+#endif /* BCONFIG_FLAT_HPP_ */
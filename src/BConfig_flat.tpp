@@ -0,0 +1,62 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+inline std::ostream & operator<< (std::ostream &out, const bconfig::BConfig_flat & b){
+	b.print(out,0);
+	return out;
+}
+
+
+
+namespace bconfig{
+
+	inline BConfig_flat::Value_range BConfig_flat::get_values_view(std::string_view key, bool do_throw)const{
+		const detail::Flat_tree::Key *k = tree ? tree->find_key(node,key) : nullptr;
+		if(k==nullptr){
+			if(do_throw){throw Error_BConfig_get("Missing value",key);}
+			else{return Value_range();}
+		}
+		return Value_range(tree.get(), tree->values + k->values_begin, tree->values + k->values_end);
+	}
+
+	inline bool   BConfig_flat::has_unique_value(std::string_view key)const{return get_values_view(key,false).size()==1;}
+	inline bool   BConfig_flat::has_values      (std::string_view key)const{return !get_values_view(key,false).empty();}
+	inline size_t BConfig_flat::count_values    (std::string_view key)const{return get_values_view(key,false).size();}
+
+	inline std::string_view BConfig_flat::get_value_view(std::string_view key)const{
+		auto d = get_values_view(key);
+		if(d.size()!=1){
+			std::string vvv;
+			for(std::string_view i : d){vvv +=" "; vvv+=i;}
+			throw Error_BConfig_get("Multiple values",key,vvv);}
+		return d[0];
+	}
+
+
+	template< typename return_t>
+	inline std::deque<return_t> BConfig_flat::get_values(std::string_view key, bool do_throw)const{
+		std::deque<return_t> r;
+		for(std::string_view i : get_values_view(key,do_throw)){r.push_back(bconfig::convert<return_t>(i));}
+		return r;
+	}
+
+
+	template< typename return_t>
+	inline return_t BConfig_flat::get_unique_value(std::string_view key, const return_t &default_v)const{
+		auto d = get_values_view(key,false);
+		if(d.size()!=1){return default_v;}
+		return bconfig::convert<return_t>(d[0]);
+	}
+
+	template<>
+	inline std::string BConfig_flat::get_unique_value(std::string_view key, const std::string &default_v)const{
+		auto d = get_values_view(key,false);
+		if(d.empty()){return default_v;}
+		return std::string(get_value_view(key)); //throws Multiple values
+	}
+
+}//end namespace bconfig
@@ -0,0 +1,46 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include "BConfig_handle.hpp"
+
+
+using namespace bconfig;
+
+
+
+Snapshot bconfig::freeze(BConfig &&b){
+	b.parse_lazy_blocks();
+	return std::make_shared<const BConfig>(std::move(b));
+}
+
+
+
+uint64_t Handle::next_version(){
+	static std::atomic<uint64_t> last(0);
+	return last.fetch_add(1,std::memory_order_relaxed)+1;
+}
+
+
+
+Handle::Handle(Snapshot s):current(std::move(s)),version(next_version()){}
+
+
+
+void Handle::publish(Snapshot s){
+	std::lock_guard<std::mutex> lock(publish_m);
+	std::atomic_store(&current,std::move(s));
+	version.store(next_version(),std::memory_order_release);
+	versions.fetch_add(1,std::memory_order_relaxed);
+}
+
+
+
+void Handle::refresh(Reader &r, uint64_t v)const{
+	//the snapshot may be newer than v, the next read then refreshes again : readers never miss a publish
+	r.snapshot = std::atomic_load(&current);
+	r.version  = v;
+}
@@ -0,0 +1,93 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_handle.hpp
+ * \brief Share a configuration between threads, and replace it while they read it.
+ * 		A Snapshot is an immutable BConfig : getters are const, and freeze parses the lazy blocks so that they never lock.
+ * 		A Handle holds the current Snapshot. Handle::publish replaces it atomically, readers that still use the previous one keep it alive.
+ *
+ * 		Each reader thread owns a Handle::Reader. Handle::read(Reader &) compares a version number, and returns the snapshot cached in the reader :
+ * 		no lock, no allocation, no reference count update. After a publish, the first read of each Reader fetches the new snapshot once.
+ *
+ * 		Example :
+ * 		  bconfig::Handle h(bconfig::freeze(bconfig::BConfig("server.conf")));
+ * 		  //worker thread
+ * 		  bconfig::Handle::Reader r;
+ * 		  while(...){ size_t n = h.read(r).get_unique_value<size_t>("threads"); ... }
+ * 		  //control thread
+ * 		  h.publish(bconfig::freeze(bconfig::BConfig("server.conf")));
+ */
+
+#ifndef BCONFIG_HANDLE_HPP_
+#define BCONFIG_HANDLE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "BConfig.hpp"
+
+
+namespace bconfig{
+
+/**\brief An immutable BConfig, shared between threads*/
+typedef std::shared_ptr<const BConfig> Snapshot;
+
+/**\brief make a Snapshot from b : lazy blocks are parsed (see BConfig::parse_lazy_blocks), then b is moved in the snapshot*/
+Snapshot freeze(BConfig &&b);
+
+
+
+struct Handle{
+
+	/**\brief the cache of a reader thread, see Handle::read. Not shared between threads.
+	 * A Reader may be used with several Handles : it then fetches the snapshot again each time it changes of Handle.*/
+	struct Reader{
+		uint64_t version=0; //0 : nothing cached
+		Snapshot snapshot;
+	};
+
+	/**\brief hold s, s must not be null*/
+	explicit Handle(Snapshot s);
+
+	Handle(const Handle &)=delete;
+	Handle &operator=(const Handle &)=delete;
+
+	/**\brief replace the current snapshot, s must not be null. Readers see it at their next read.*/
+	void publish(Snapshot s);
+
+	/**\return the current snapshot (std::atomic_load : may take a short internal lock, and updates the reference count)*/
+	Snapshot load()const{return std::atomic_load(&current);}
+
+	/**\return the current snapshot, cached in r. Valid until the next read with r.
+	 * Wait free and allocation free, unless a snapshot was published since the previous read with r.*/
+	const BConfig &read(Reader &r)const{
+		const uint64_t v = version.load(std::memory_order_acquire);
+		if(v!=r.version){refresh(r,v);}
+		return *r.snapshot;
+	}
+
+	/**\return the number of published snapshots, including the first one*/
+	uint64_t count_versions()const{return versions.load(std::memory_order_acquire);}
+
+private:
+	void refresh(Reader &r, uint64_t v)const;
+
+	//versions are unique in the process : a Reader never mistakes the snapshot of another Handle, even one built where a destroyed Handle was
+	static uint64_t next_version();
+
+	Snapshot              current; //accessed with std::atomic_load / std::atomic_store
+	std::atomic<uint64_t> version;
+	std::atomic<uint64_t> versions{1}; //published snapshots, including the first one
+	std::mutex            publish_m;
+};
+
+
+}//end namespace bconfig
+
+#endif /* BCONFIG_HANDLE_HPP_ */
@@ -0,0 +1,77 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_key.hpp
+ * \brief Keys that carry their hash.
+ * 		BConfig indexes its values and sub-blocks by Key : the hash is computed once, when the Key is built.
+ * 		Getters take a Key, built implicitly from std::string_view, std::string or a literal (the hash is then computed at each call),
+ * 		or given ready-made with the _key literal, whose hash is computed at compile time.
+ *
+ * 		Example :
+ * 		  using namespace bconfig::literals;
+ * 		  size_t s = b.get_unique_value<size_t>("size"_key);
+ *
+ * 		  static constexpr bconfig::Key size_k = "size"_key; //the hash is guaranteed to be computed at compile time
+ */
+
+#ifndef BCONFIG_KEY_HPP_
+#define BCONFIG_KEY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+namespace bconfig{
+
+	namespace detail{
+		/**\brief FNV-1a hash of s, usable at compile time*/
+		constexpr size_t fnv1a(std::string_view s){
+			uint64_t h = 14695981039346656037ull;
+			for(char c : s){
+				h ^= static_cast<unsigned char>(c);
+				h *= 1099511628211ull;
+			}
+			return static_cast<size_t>(h);
+		}
+	}
+
+
+	/**\brief A key and its hash. The text is not owned : it must outlive the Key.*/
+	struct Key{
+		std::string_view name;
+		size_t           hash;
+
+		constexpr Key(std::string_view s):name(s),hash(detail::fnv1a(s)){}
+		constexpr Key(const char *s):Key(std::string_view(s)){}
+		Key(const std::string &s):Key(std::string_view(s)){}
+
+		constexpr operator std::string_view()const{return name;}
+
+		/**\brief hashes first : different keys are told apart without comparing the text*/
+		constexpr bool operator==(const Key &k)const{return hash==k.hash and name==k.name;}
+		constexpr bool operator!=(const Key &k)const{return !(*this==k);}
+	};
+
+
+	namespace detail{
+		/**\brief hasher of the BConfig indexes, returns the hash stored in the key*/
+		struct Key_hash{
+			size_t operator()(const Key &k)const{return k.hash;}
+		};
+	}
+
+
+	namespace literals{
+		/**\brief "size"_key is a Key whose hash is computed at compile time*/
+		constexpr Key operator""_key(const char *s, size_t n){return Key(std::string_view(s,n));}
+	}
+
+}//end namespace bconfig
+
+#endif /* BCONFIG_KEY_HPP_ */
@@ -0,0 +1,168 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include "BConfig_query.hpp"
+#include "helpers/str_tools.h"
+
+#include <charconv>
+
+
+using namespace bconfig;
+
+
+
+Query::Query(const Query &q):p_path(q.p_path),steps(q.steps){rebase(q);}
+Query::Query(Query &&q):p_path(q.p_path),steps(std::move(q.steps)){rebase(q);}
+
+Query &Query::operator=(const Query &q){
+	if(this!=&q){p_path=q.p_path; steps=q.steps; rebase(q);}
+	return *this;
+}
+
+Query &Query::operator=(Query &&q){
+	if(this!=&q){p_path=q.p_path; steps=std::move(q.steps); rebase(q);}
+	return *this;
+}
+
+
+
+void Query::rebase(const Query &from){
+	auto move_key = [&](Key &k){
+		if(k.name.empty()){return;} //index selectors have no key
+		k.name = std::string_view(p_path.data()+(k.name.data()-from.p_path.data()),k.name.size());
+	};
+	for(Step &step : steps){
+		move_key(step.name);
+		for(Selector &sel : step.selectors){move_key(sel.key);}
+	}
+}
+
+
+
+Query::Query(std::string_view path_):p_path(path_){
+	using namespace str;
+	const std::string_view path = p_path; //keys are views on p_path, hashed once here
+
+	size_t pos=0;
+	const size_t n = path.size();
+
+	while(true){
+		Step step;
+
+		//name, up to '[' '/' or end
+		size_t name_begin = pos;
+		while(pos<n and path[pos]!='[' and path[pos]!='/'){
+			if(path[pos]==']'){throw Error_BConfig_query("unexpected ]",path,pos);}
+			++pos;
+		}
+		std::string_view name = path.substr(name_begin,pos-name_begin);
+		trim(name," \t");
+		if(name.empty()){throw Error_BConfig_query("empty step",path,name_begin);}
+		step.any_name = (name=="*");
+		step.name     = Key(name);
+
+		//selectors
+		while(pos<n and path[pos]=='['){
+			size_t sel_begin = ++pos;
+			while(pos<n and path[pos]!=']'){++pos;}
+			if(pos==n){throw Error_BConfig_query("missing ]",path,sel_begin);}
+			std::string_view sel = path.substr(sel_begin,pos-sel_begin);
+			++pos; //skip ]
+			trim(sel," \t");
+			if(sel.empty()){throw Error_BConfig_query("empty selector",path,sel_begin);}
+
+			if(sel=="*"){continue;}
+
+			if(step.selectors.size()==max_selectors){throw Error_BConfig_query("too many selectors",path,sel_begin);}
+			Selector s;
+
+			size_t idx=0;
+			auto r = std::from_chars(sel.data(),sel.data()+sel.size(),idx);
+			if(r.ec==std::errc() and r.ptr==sel.data()+sel.size()){
+				s.kind  = Selector::Kind::index;
+				s.index = idx;
+				step.selectors.push_back(s);
+				continue;
+			}
+
+			size_t eq = sel.find('=');
+			if(eq==std::string_view::npos){
+				s.kind = Selector::Kind::has;
+				s.key  = Key(sel);
+				step.selectors.push_back(s);
+				continue;
+			}
+
+			std::string_view key   = sel.substr(0,eq);
+			std::string_view value = sel.substr(eq+1);
+			s.kind = Selector::Kind::equal;
+			if(!key.empty() and key.back()=='!'){s.kind = Selector::Kind::not_equal; key.remove_suffix(1);}
+			trim(key," \t");
+			trim(value," \t");
+			if(key.empty()){throw Error_BConfig_query("empty selector key",path,sel_begin);}
+			s.key   = Key(key);
+			s.value = std::string(value);
+			step.selectors.push_back(s);
+		}
+
+		steps.push_back(std::move(step));
+
+		if(pos==n){break;}
+		if(path[pos]!='/'){throw Error_BConfig_query("expected / or [",path,pos);}
+		++pos;
+	}
+}
+
+
+
+bool Query::match(const Selector &s, const BConfig &b){
+	const auto &d = b.get_values_view(s.key,false);
+	switch(s.kind){
+		case Selector::Kind::has      : return !d.empty();
+		case Selector::Kind::equal    : for(std::string_view v : d){if(v==s.value){return true; }} return false;
+		case Selector::Kind::not_equal: for(std::string_view v : d){if(v==s.value){return false;}} return true;
+		case Selector::Kind::index    : break; //handled by run_blocks
+	}
+	return true;
+}
+
+
+
+size_t Query::count_blocks(const BConfig &b)const{
+	size_t R=0;
+	for_each_block(b,[&R](const BConfig &){++R;});
+	return R;
+}
+
+
+
+std::vector<const BConfig*> Query::get_blocks(const BConfig &b, bool throw_b)const{
+	std::vector<const BConfig*> R;
+	for_each_block(b,[&R](const BConfig &c){R.push_back(&c);});
+	if(R.empty() and throw_b){throw Error_BConfig_get("Missing block",p_path);}
+	return R;
+}
+
+
+
+std::vector<std::string_view> Query::get_values_view(const BConfig &b, bool do_throw)const{
+	std::vector<std::string_view> R;
+	for_each_value(b,[&R](std::string_view v){R.push_back(v);});
+	if(R.empty() and do_throw){throw Error_BConfig_get("Missing value",p_path);}
+	return R;
+}
+
+
+
+std::string_view Query::get_value_view(const BConfig &b)const{
+	std::string_view R;
+	size_t count=0;
+	for_each_value(b,[&](std::string_view v){if(count++==0){R=v;}});
+	if(count==0){throw Error_BConfig_get("Missing value",p_path);}
+	if(count!=1){throw Error_BConfig_get("Multiple values",p_path);}
+	return R;
+}
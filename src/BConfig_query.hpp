@@ -0,0 +1,133 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_query.hpp
+ * \brief Compiled path queries on a BConfig tree.
+ * 		A query is a list of steps separated by '/'. Each step is a block key, or * for any key,
+ * 		followed by 0 or more selectors applied in order :
+ * 		 - [*]           all the blocks (same as no selector)
+ * 		 - [n]           the n-th block (0 based) among the blocks that passed the previous selectors
+ * 		 - [key]         blocks that have at least one value for key
+ * 		 - [key=value]   blocks that have value among the values of key
+ * 		 - [key!=value]  blocks that do not have value among the values of key
+ * 		Keys and values of selectors are trimmed, and cannot contain ']'.
+ *
+ * 		Example : tree[name=cool tree]/branch[*]/leave/color
+ *
+ * 		The path is compiled once by the Query constructor. Running a query walks the tree by reference and copies nothing.
+ * 		With Query::for_each_block, all the steps are block steps.
+ * 		With Query::for_each_value, the last step is a value key, optionally followed by an index selector [n].
+ */
+
+#ifndef BCONFIG_QUERY_HPP_
+#define BCONFIG_QUERY_HPP_
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BConfig.hpp"
+
+
+namespace bconfig{
+
+
+struct Query{
+
+	/**\brief compile a query path, see BConfig_query.hpp for the syntax
+	 * \throw Error_BConfig_query if the path is invalid*/
+	explicit Query(std::string_view path);
+
+	/**\brief copies keep the compiled path : the keys of the copy point into its own path*/
+	Query(const Query &q);
+	Query(Query &&q);
+	Query &operator=(const Query &q);
+	Query &operator=(Query &&q);
+
+	/**\return the query path, as given to the constructor*/
+	const std::string &path()const{return p_path;}
+
+
+	/**\brief call f(const BConfig &) for each block that matches the query, in input order*/
+	template<typename F>
+	void for_each_block(const BConfig &b, F &&f)const;
+
+	/**\brief call f(std::string_view) for each value that matches the query, in input order
+	 * \throw Error_BConfig_query if the last step cannot be a value key (wildcard or predicate)*/
+	template<typename F>
+	void for_each_value(const BConfig &b, F &&f)const;
+
+
+	/**\return the number of blocks that match the query*/
+	size_t count_blocks(const BConfig &b)const;
+
+	/**\return pointers on the blocks that match the query, in input order. Blocks are not copied.
+	 * \param throw_b bool. If true throw a Error_BConfig_get error if 0 blocks are found.*/
+	std::vector<const BConfig*> get_blocks(const BConfig &b, bool throw_b=true)const;
+
+	/**\return the values that match the query, in input order, see BConfig::get_values_view for lifetime.
+	 * \param do_throw bool. If true throw a Error_BConfig_get error if 0 values are found.*/
+	std::vector<std::string_view> get_values_view(const BConfig &b, bool do_throw=true)const;
+
+	/**\return the values that match the query converted to return_t, see BConfig::get_values. Values decoded by the parse (Parse_options::decode_values) are not converted again.*/
+	template< typename return_t = std::string>
+	std::deque<return_t> get_values(const BConfig &b, bool do_throw=true)const;
+
+	/**\return the unique value that matches the query, see BConfig::get_value_view
+	 * \throw Error_BConfig_get if not exactly one value.*/
+	std::string_view get_value_view(const BConfig &b)const;
+
+	/**\return the unique value that matches the query converted to return_t, see BConfig::get_unique_value
+	 * \throw Error_BConfig_get if not exactly one value.
+	 * \throw Error_BConfig_convert if conversion fails.*/
+	template< typename return_t = std::string>
+	return_t get_unique_value(const BConfig &b)const;
+
+
+private:
+	static const size_t max_selectors=8; //per step
+
+	struct Selector{
+		enum struct Kind{index,has,equal,not_equal};
+		Kind        kind;
+		size_t      index=0;
+		Key         key=Key(""); //view on p_path
+		std::string value;
+	};
+
+	struct Step{
+		Key                   name=Key(""); //view on p_path
+		bool                  any_name=false;
+		std::vector<Selector> selectors;
+	};
+
+	//point the keys, copied from the steps of from, into p_path
+	void rebase(const Query &from);
+
+	static bool match(const Selector &s, const BConfig &b);
+
+	template<typename F>
+	void run_blocks(const BConfig &b, size_t step, size_t end, F &f)const;
+
+	//call f(const detail::Value_list &, size_t i) for the i-th value of each list that matches the query, in input order
+	template<typename F>
+	void run_values(const BConfig &b, F &&f)const;
+
+	std::string       p_path;
+	std::vector<Step> steps;
+};
+
+
+}//end namespace bconfig
+
+
+
+//inline & template code
+#include "BConfig_query.tpp"
+
+#endif /* BCONFIG_QUERY_HPP_ */
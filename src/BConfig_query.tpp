@@ -0,0 +1,89 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+namespace bconfig{
+
+	//apply steps [step,end) from b, call f on each block reached after the last step
+	template<typename F>
+	inline void Query::run_blocks(const BConfig &b, size_t step, size_t end, F &f)const{
+		if(step==end){f(b);return;}
+		const Step &s = steps[step];
+
+		//per selector : number of candidates that reached it, used by index selectors
+		size_t reached[max_selectors]={};
+
+		auto visit = [&](const BConfig &c){
+			for(size_t i=0;i<s.selectors.size();++i){
+				const Selector &sel = s.selectors[i];
+				if(sel.kind==Selector::Kind::index){
+					if(reached[i]++ != sel.index){return;}
+				}else if(!match(sel,c)){return;}
+			}
+			run_blocks(c,step+1,end,f);
+		};
+
+		if(s.any_name){
+			for(const auto &kb : b.body().blocks){visit(kb.second);}
+		}else{
+			for(const BConfig &c : b.get_blocks_view(s.name,false)){visit(c);}
+		}
+	}
+
+
+	template<typename F>
+	inline void Query::for_each_block(const BConfig &b, F &&f)const{
+		run_blocks(b,0,steps.size(),f);
+	}
+
+
+	template<typename F>
+	inline void Query::run_values(const BConfig &b, F &&f)const{
+		const Step &last = steps.back();
+		if(last.any_name){throw Error_BConfig_query("a value key cannot be *",p_path,p_path.size());}
+		if(last.selectors.size()>1 or (last.selectors.size()==1 and last.selectors[0].kind!=Selector::Kind::index)){
+			throw Error_BConfig_query("a value key only accepts one index selector",p_path,p_path.size());
+		}
+
+		auto on_block = [&](const BConfig &c){
+			const detail::Value_list *d = c.find_values(last.name);
+			if(d==nullptr){return;}
+			if(last.selectors.empty()){
+				for(size_t i=0;i<d->text.size();++i){f(*d,i);}
+			}else if(last.selectors[0].index < d->text.size()){
+				f(*d,last.selectors[0].index);
+			}
+		};
+		run_blocks(b,0,steps.size()-1,on_block);
+	}
+
+
+	template<typename F>
+	inline void Query::for_each_value(const BConfig &b, F &&f)const{
+		run_values(b,[&f](const detail::Value_list &d, size_t i){f(d.text[i]);});
+	}
+
+
+	template< typename return_t>
+	inline std::deque<return_t> Query::get_values(const BConfig &b, bool do_throw)const{
+		std::deque<return_t> R;
+		run_values(b,[&R](const detail::Value_list &d, size_t i){R.push_back(detail::convert_value<return_t>(d,i));});
+		if(R.empty() and do_throw){throw Error_BConfig_get("Missing value",p_path);}
+		return R;
+	}
+
+
+	template< typename return_t>
+	inline return_t Query::get_unique_value(const BConfig &b)const{
+		const detail::Value_list *R=nullptr;
+		size_t i=0, count=0;
+		run_values(b,[&](const detail::Value_list &d, size_t j){if(count++==0){R=&d; i=j;}});
+		if(count==0){throw Error_BConfig_get("Missing value",p_path);}
+		if(count!=1){throw Error_BConfig_get("Multiple values",p_path);}
+		return detail::convert_value<return_t>(*R,i);
+	}
+
+}//end namespace bconfig
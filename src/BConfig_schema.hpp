@@ -0,0 +1,140 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_schema.hpp
+ * \brief Bind a BConfig block to a struct, with a schema that maps keys and sub-blocks to members.
+ * 		Binding walks the values and the sub-blocks of the block once, and finds the member of each key with one hash lookup.
+ * 		Values are converted with bconfig::convert (i.e., Convert_t, so custom types work), or taken decoded (see Parse_options::decode_values).
+ * 		All the errors are collected (missing, multiple, unknown, conversion), in nested blocks too, then reported at once.
+ *
+ * 		Example :
+ * 		  struct Trunk{ size_t size; std::string type; };
+ * 		  struct Tree { std::string name; Trunk trunk; std::vector<std::string> tags; bool dead; };
+ *
+ * 		  bconfig::Schema<Trunk> trunk;
+ * 		  trunk.required("size",&Trunk::size).optional("type",&Trunk::type,std::string("small"));
+ *
+ * 		  bconfig::Schema<Tree> tree;
+ * 		  tree.required("name",&Tree::name).block("trunk",&Tree::trunk,trunk).repeated("tag",&Tree::tags).yes_no("dead",&Tree::dead,false);
+ *
+ * 		  for(const bconfig::BConfig &b : config.get_blocks_view("tree")){ Tree t = tree.bind(b); ... }
+ */
+
+#ifndef BCONFIG_SCHEMA_HPP_
+#define BCONFIG_SCHEMA_HPP_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BConfig.hpp"
+
+
+namespace bconfig{
+
+
+template<typename T>
+struct Schema{
+
+	Schema()=default;
+	Schema(const Schema &s){*this=s;}
+	Schema &operator=(const Schema &s);
+
+
+	/**\brief key must have exactly one value, converted to V*/
+	template<typename V>
+	Schema &required(std::string_view key, V T::*member);
+
+	/**\brief key has zero or one value, converted to V. default_v is used when key is missing*/
+	template<typename V>
+	Schema &optional(std::string_view key, V T::*member, const V &default_v);
+
+	/**\brief all the values of key, in input order, converted to C::value_type and appended to an empty C (e.g., std::vector, std::deque)
+	 * \param min_count size_t. Minimum number of values*/
+	template<typename C>
+	Schema &repeated(std::string_view key, C T::*member, size_t min_count=0);
+
+	/**\brief key must have exactly one value : "yes","y","no" or "n"*/
+	Schema &yes_no(std::string_view key, bool T::*member);
+
+	/**\brief key has zero or one value : "yes","y","no", "n" or "". default_v is used when key is missing or the value is empty*/
+	Schema &yes_no(std::string_view key, bool T::*member, bool default_v);
+
+	/**\brief key must have exactly one sub-block, bound with s. s is copied.*/
+	template<typename S>
+	Schema &block(std::string_view key, S T::*member, const Schema<S> &s);
+
+	/**\brief key has zero or one sub-block, bound with s. The member is left unchanged when the block is missing. s is copied.*/
+	template<typename S>
+	Schema &optional_block(std::string_view key, S T::*member, const Schema<S> &s);
+
+	/**\brief all the sub-blocks of key, in input order, bound with s and appended to an empty C. s is copied.
+	 * \param min_count size_t. Minimum number of blocks*/
+	template<typename C>
+	Schema &blocks(std::string_view key, C T::*member, const Schema<typename C::value_type> &s, size_t min_count=0);
+
+	/**\brief if true, keys and sub-blocks that are not in the schema are errors. Default : false, they are ignored.*/
+	Schema &strict(bool b=true){p_strict=b; return *this;}
+
+
+	/**\brief fill R from b
+	 * \param errors std::vector<std::string> &. Errors are appended, one per problem, prefixed with their block path.
+	 * \param path const std::string &. The path of b, prefix of the errors
+	 * \return true if there is no error. R is then completely filled.*/
+	bool bind(const BConfig &b, T &R, std::vector<std::string> &errors, const std::string &path="")const;
+
+	/**\brief fill R from b
+	 * \throw Error_BConfig_bind with all the errors*/
+	void bind(const BConfig &b, T &R)const;
+
+	/**\return a T filled from b, T must be default constructible
+	 * \throw Error_BConfig_bind with all the errors*/
+	T bind(const BConfig &b)const{T R; bind(b,R); return R;}
+
+
+private:
+	struct Field{
+		std::string key;
+		bool        is_block =false;
+		bool        required =false; //a missing key is an error
+		bool        unique   =true;  //more than one value or block is an error
+		size_t      min_count=0;
+
+		//values fields : set the member from all the values of the key. May throw a BConfig error, reported for this key
+		std::function<void(T &, const detail::Value_list &)> set_values;
+
+		//block fields : bind the n-th block (0 based) of the key
+		std::function<void(T &, const BConfig &, size_t n, std::vector<std::string> &, const std::string &path)> set_block;
+
+		//called when the key is missing and not required, may be empty
+		std::function<void(T &)> set_default;
+	};
+
+	Field &add(std::string_view key, bool is_block);
+	void   reindex();
+
+	static std::string child_path(const std::string &path, std::string_view key);
+
+	std::deque<Field> fields; //a deque : the indexes below refer to the keys of the fields
+	std::unordered_map<Key, size_t, detail::Key_hash> value_index;
+	std::unordered_map<Key, size_t, detail::Key_hash> block_index;
+	bool p_strict=false;
+};
+
+
+}//end namespace bconfig
+
+
+
+//inline & template code
+#include "BConfig_schema.tpp"
+
+#endif /* BCONFIG_SCHEMA_HPP_ */
@@ -0,0 +1,250 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+namespace bconfig{
+
+	template<typename T>
+	inline Schema<T> &Schema<T>::operator=(const Schema &s){
+		if(this==&s){return *this;}
+		fields   = s.fields;
+		p_strict = s.p_strict;
+		reindex();
+		return *this;
+	}
+
+
+	template<typename T>
+	inline void Schema<T>::reindex(){
+		value_index.clear();
+		block_index.clear();
+		for(size_t i=0; i<fields.size(); ++i){
+			(fields[i].is_block ? block_index : value_index)[fields[i].key] = i;
+		}
+	}
+
+
+	template<typename T>
+	inline typename Schema<T>::Field &Schema<T>::add(std::string_view key, bool is_block){
+		//a key given twice : the last definition replaces the first one
+		auto &index = is_block ? block_index : value_index;
+		auto f = index.find(key);
+		if(f!=index.end()){
+			const size_t i = f->second;
+			index.erase(f);
+			fields[i]          = Field();
+			fields[i].key      = std::string(key);
+			fields[i].is_block = is_block;
+			index[fields[i].key] = i;
+			return fields[i];
+		}
+
+		fields.emplace_back();
+		Field &R   = fields.back();
+		R.key      = std::string(key);
+		R.is_block = is_block;
+		index[R.key] = fields.size()-1;
+		return R;
+	}
+
+
+	template<typename T>
+	inline std::string Schema<T>::child_path(const std::string &path, std::string_view key){
+		std::string R = path;
+		if(!R.empty()){R+="/";}
+		R += key;
+		return R;
+	}
+
+
+
+	//values
+
+	template<typename T>
+	template<typename V>
+	inline Schema<T> &Schema<T>::required(std::string_view key, V T::*member){
+		Field &f = add(key,false);
+		f.required   = true;
+		f.set_values = [member](T &R, const detail::Value_list &d){R.*member = detail::convert_value<V>(d,0);};
+		return *this;
+	}
+
+
+	template<typename T>
+	template<typename V>
+	inline Schema<T> &Schema<T>::optional(std::string_view key, V T::*member, const V &default_v){
+		Field &f = add(key,false);
+		f.set_values  = [member](T &R, const detail::Value_list &d){R.*member = detail::convert_value<V>(d,0);};
+		f.set_default = [member,default_v](T &R){R.*member = default_v;};
+		return *this;
+	}
+
+
+	template<typename T>
+	template<typename C>
+	inline Schema<T> &Schema<T>::repeated(std::string_view key, C T::*member, size_t min_count){
+		Field &f = add(key,false);
+		f.unique     = false;
+		f.required   = min_count>0;
+		f.min_count  = min_count;
+		f.set_values = [member](T &R, const detail::Value_list &d){
+			C c;
+			for(size_t i=0; i<d.text.size(); ++i){c.push_back(detail::convert_value<typename C::value_type>(d,i));}
+			R.*member = std::move(c);
+		};
+		f.set_default = [member](T &R){R.*member = C();};
+		return *this;
+	}
+
+
+	namespace detail{
+		//the first value of d, "yes","y","no" or "n"
+		inline bool bind_yes_no(const Value_list &d){
+			if(!d.decoded.empty() and d.decoded[0].kind==Decoded::Kind::yes_no){return d.decoded[0].yes_no;}
+			std::string_view s = d.text[0];
+			if(s=="y" or s=="yes"){return true;}
+			if(s=="n" or s=="no" ){return false;}
+			throw Error_BConfig_get("get_yes_no : invalid string","",s);
+		}
+	}
+
+
+	template<typename T>
+	inline Schema<T> &Schema<T>::yes_no(std::string_view key, bool T::*member){
+		Field &f = add(key,false);
+		f.required   = true;
+		f.set_values = [member](T &R, const detail::Value_list &d){R.*member = detail::bind_yes_no(d);};
+		return *this;
+	}
+
+
+	template<typename T>
+	inline Schema<T> &Schema<T>::yes_no(std::string_view key, bool T::*member, bool default_v){
+		Field &f = add(key,false);
+		f.set_values  = [member,default_v](T &R, const detail::Value_list &d){
+			R.*member = d.text[0]=="" ? default_v : detail::bind_yes_no(d);
+		};
+		f.set_default = [member,default_v](T &R){R.*member = default_v;};
+		return *this;
+	}
+
+
+
+	//blocks
+
+	template<typename T>
+	template<typename S>
+	inline Schema<T> &Schema<T>::block(std::string_view key, S T::*member, const Schema<S> &s){
+		Field &f = add(key,true);
+		f.required  = true;
+		auto schema = std::make_shared<const Schema<S> >(s);
+		f.set_block = [member,schema](T &R, const BConfig &b, size_t, std::vector<std::string> &errors, const std::string &path){
+			schema->bind(b,R.*member,errors,path);
+		};
+		return *this;
+	}
+
+
+	template<typename T>
+	template<typename S>
+	inline Schema<T> &Schema<T>::optional_block(std::string_view key, S T::*member, const Schema<S> &s){
+		block(key,member,s);
+		fields[block_index.find(key)->second].required = false;
+		return *this;
+	}
+
+
+	template<typename T>
+	template<typename C>
+	inline Schema<T> &Schema<T>::blocks(std::string_view key, C T::*member, const Schema<typename C::value_type> &s, size_t min_count){
+		Field &f = add(key,true);
+		f.unique    = false;
+		f.required  = min_count>0;
+		f.min_count = min_count;
+		auto schema = std::make_shared<const Schema<typename C::value_type> >(s);
+		f.set_block = [member,schema](T &R, const BConfig &b, size_t n, std::vector<std::string> &errors, const std::string &path){
+			if(n==0){R.*member = C();}
+			typename C::value_type e;
+			schema->bind(b,e,errors,path+"["+std::to_string(n)+"]");
+			(R.*member).push_back(std::move(e));
+		};
+		f.set_default = [member](T &R){R.*member = C();};
+		return *this;
+	}
+
+
+
+	//bind
+
+	template<typename T>
+	inline bool Schema<T>::bind(const BConfig &lazy_b, T &R, std::vector<std::string> &errors, const std::string &path)const{
+		const BConfig &b = lazy_b.body();
+		const size_t errors_begin = errors.size();
+
+		//number of values or blocks found for each field
+		std::vector<size_t> found(fields.size(),0);
+
+		for(const auto &v : b.values){
+			auto f = value_index.find(v.first);
+			if(f==value_index.end()){
+				if(p_strict){errors.push_back(child_path(path,v.first)+" : unknown key");}
+				continue;
+			}
+
+			const Field &field = fields[f->second];
+			const size_t n     = v.second.text.size();
+			found[f->second]   = n;
+			if(field.unique and n!=1){
+				std::string vvv;
+				for(std::string_view i : v.second.text){vvv +=" "; vvv+=i;}
+				errors.push_back(child_path(path,v.first)+" : multiple values :"+vvv);
+				continue;
+			}
+
+			try{
+				field.set_values(R,v.second);
+			}catch(const Error_BConfig_base &e){
+				errors.push_back(child_path(path,v.first)+" : "+e.what());
+			}
+		}
+
+		for(const auto &kb : b.blocks){
+			auto f = block_index.find(kb.first);
+			if(f==block_index.end()){
+				if(p_strict){errors.push_back(child_path(path,kb.first)+" : unknown block");}
+				continue;
+			}
+
+			const Field &field = fields[f->second];
+			const size_t n     = found[f->second]++;
+			if(field.unique and n>0){
+				if(n==1){errors.push_back(child_path(path,kb.first)+" : multiple blocks");}
+				continue;
+			}
+			field.set_block(R,kb.second,n,errors,child_path(path,kb.first));
+		}
+
+		for(size_t i=0; i<fields.size(); ++i){
+			const Field &field = fields[i];
+			if(found[i]==0){
+				if(field.required){errors.push_back(child_path(path,field.key)+(field.is_block ? " : missing block" : " : missing value"));}
+				else if(field.set_default){field.set_default(R);}
+			}else if(found[i]<field.min_count){
+				errors.push_back(child_path(path,field.key)+" : "+std::to_string(found[i])+(field.is_block ? " blocks" : " values")+", expected at least "+std::to_string(field.min_count));
+			}
+		}
+
+		return errors.size()==errors_begin;
+	}
+
+
+	template<typename T>
+	inline void Schema<T>::bind(const BConfig &b, T &R)const{
+		std::vector<std::string> errors;
+		if(!bind(b,R,errors)){throw Error_BConfig_bind(errors);}
+	}
+
+}//end namespace bconfig
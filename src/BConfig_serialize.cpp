@@ -0,0 +1,288 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include "BConfig.hpp"
+#include "helpers/OpenFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BCONFIG_SERIALIZE_FD
+#include <unistd.h>
+#endif
+
+
+using namespace bconfig;
+
+
+
+namespace bconfig{ namespace detail{
+
+	//writes a tree as text into an Out : a buffer that is filled, then flushed
+	struct Serializer{
+		const Serialize_options &opt;
+		std::vector<std::string_view> texts; //Serialize_options::Order::input : keys are ranked by their position in these texts
+
+		typedef std::pair<const Key, Value_list> key_values_t;
+		typedef std::pair<uint64_t,const key_values_t*> ranked_t;
+
+		//scratch of order, reused by every block
+		mutable std::vector<ranked_t> ranked, ranked_tmp;
+		mutable std::vector<std::pair<std::string_view,const key_values_t*> > named;
+
+		Serializer(const BConfig &b, const Serialize_options &opt_):opt(opt_){
+			if(opt.order==Serialize_options::Order::input and b.storage){texts = b.storage->texts();}
+		}
+
+		//position of s in the texts, as if they were concatenated. Views that are not in the texts come last.
+		uint64_t rank(std::string_view s)const{
+			const std::less<const char*> before;
+			uint64_t R=0;
+			for(std::string_view t : texts){
+				if(!before(s.data(),t.data()) and before(s.data(),t.data()+t.size())){return R+static_cast<uint64_t>(s.data()-t.data());}
+				R+=t.size();
+			}
+			return std::numeric_limits<uint64_t>::max();
+		}
+
+		//sort ranked by rank : radix sort, 11 bits at a time, on the bits that vary
+		void sort_ranked()const{
+			if(ranked.size()<256){
+				std::sort(ranked.begin(),ranked.end(),[](const ranked_t &x, const ranked_t &y){return x.first<y.first;});
+				return;
+			}
+			uint64_t max_rank=0;
+			for(const ranked_t &r : ranked){if(r.first!=std::numeric_limits<uint64_t>::max()){max_rank = std::max(max_rank,r.first);}}
+
+			ranked_tmp.resize(ranked.size());
+			const unsigned bits=11;
+			for(unsigned shift=0; shift<64 and (shift==0 or (max_rank>>shift)!=0); shift+=bits){
+				size_t count[(1u<<bits)+1]={0};
+				auto digit = [&](const ranked_t &r){
+					return r.first==std::numeric_limits<uint64_t>::max() ? (1u<<bits)-1 : static_cast<unsigned>((r.first>>shift)&((1u<<bits)-1));
+				};
+				for(const ranked_t &r : ranked){++count[digit(r)+1];}
+				for(size_t i=1; i<=(1u<<bits); ++i){count[i]+=count[i-1];}
+				for(const ranked_t &r : ranked){ranked_tmp[count[digit(r)]++] = r;}
+				ranked.swap(ranked_tmp);
+			}
+		}
+
+		//the values of b in the order of opt
+		void order(const BConfig &b, std::vector<const key_values_t*> &R)const{
+			R.clear();
+			if(opt.order==Serialize_options::Order::sorted){
+				//sort copies of the keys : the text is contiguous, the hash nodes are not
+				named.clear();
+				for(const auto &v : b.values){named.emplace_back(v.first.name,&v);}
+				std::sort(named.begin(),named.end(),[](const auto &x, const auto &y){return x.first<y.first;});
+				for(const auto &n : named){R.push_back(n.second);}
+				return;
+			}
+
+			//a key points to its first occurrence in the input
+			ranked.clear();
+			for(const auto &v : b.values){ranked.emplace_back(rank(v.first.name),&v);}
+			sort_ranked();
+
+			//keys that are not in the texts are last, sort them by name
+			auto not_in_texts = std::find_if(ranked.begin(),ranked.end(),[](const ranked_t &r){return r.first==std::numeric_limits<uint64_t>::max();});
+			std::sort(not_in_texts,ranked.end(),[](const ranked_t &x, const ranked_t &y){return x.second->first.name<y.second->first.name;});
+			for(const ranked_t &r : ranked){R.push_back(r.second);}
+		}
+
+		size_t indent_size(size_t depth)const{return opt.compact ? 0 : 2*depth;}
+
+		size_t size(const BConfig &lazy_b, size_t depth)const{
+			const BConfig &b = lazy_b.body();
+			size_t R=0;
+			for(const auto &v : b.values){
+				for(std::string_view t : v.second.text){R += indent_size(depth)+v.first.name.size()+1+t.size()+1;}
+			}
+			for(const auto &kb : b.blocks){
+				R += indent_size(depth)+kb.first.size()+2;   //key{
+				R += size(kb.second,depth+1);
+				R += indent_size(depth)+2;                   //}
+			}
+			return R;
+		}
+
+		template<typename Out>
+		void write(const BConfig &lazy_b, size_t depth, Out &out, std::vector<const key_values_t*> &values)const{
+			const BConfig &b = lazy_b.body();
+			const size_t indent = indent_size(depth);
+
+			order(b,values);
+			for(const key_values_t *v : values){
+				for(std::string_view t : v->second.text){
+					char *p = out.reserve(indent+v->first.name.size()+1+t.size()+1);
+					p = std::fill_n(p,indent,' ');
+					p = copy(p,v->first.name);
+					*p++ = '=';
+					p = copy(p,t);
+					*p++ = '\n';
+					out.commit(p);
+				}
+			}
+
+			for(const auto &kb : b.blocks){
+				char *p = out.reserve(indent+kb.first.size()+2);
+				p = std::fill_n(p,indent,' ');
+				p = copy(p,kb.first);
+				*p++ = '{';
+				*p++ = '\n';
+				out.commit(p);
+
+				write(kb.second,depth+1,out,values);
+
+				p = out.reserve(indent+2);
+				p = std::fill_n(p,indent,' ');
+				*p++ = '}';
+				*p++ = '\n';
+				out.commit(p);
+			}
+		}
+
+		template<typename Out>
+		void write(const BConfig &b, size_t depth, Out &out)const{
+			std::vector<const key_values_t*> values; //reused by every block
+			write(b,depth,out,values);
+		}
+
+		static char *copy(char *p, std::string_view s){
+			std::memcpy(p,s.data(),s.size());
+			return p+s.size();
+		}
+	};
+
+
+	//Out for Serializer : a buffer large enough for the whole text
+	struct Buffer_out{
+		char *p;
+		char *reserve(size_t){return p;}
+		void  commit(char *end){p=end;}
+	};
+
+
+	//Out for Serializer : a fixed size buffer, given to sink.write(data,size) when full
+	template<typename Sink>
+	struct Buffered_out{
+		Sink              sink;
+		std::vector<char> buffer;
+		size_t            used=0;
+
+		explicit Buffered_out(Sink sink_):sink(std::move(sink_)),buffer(1<<20){}
+
+		char *reserve(size_t n){
+			if(used+n>buffer.size()){
+				flush();
+				if(n>buffer.size()){buffer.resize(n);} //a very long line
+			}
+			return buffer.data()+used;
+		}
+		void commit(char *end){used = static_cast<size_t>(end-buffer.data());}
+
+		void flush(){
+			sink.write(buffer.data(),used);
+			used=0;
+		}
+	};
+
+
+	//Sink for Buffered_out : a C stream, unbuffered since Buffered_out already is
+	struct File_sink{
+		std::FILE   *f;
+		std::string  where;
+
+		void write(const char *p, size_t n){
+			if(n>0 and std::fwrite(p,1,n,f)!=n){throw Error_BConfig_serialize(std::string("write failed : ")+std::strerror(errno),where);}
+		}
+	};
+
+
+#ifdef BCONFIG_SERIALIZE_FD
+	//Sink for Buffered_out : a file descriptor
+	struct Fd_sink{
+		int         fd;
+		std::string where;
+
+		void write(const char *p, size_t n){
+			while(n>0){
+				ssize_t w = ::write(fd,p,n);
+				if(w<0){
+					if(errno==EINTR){continue;}
+					throw Error_BConfig_serialize(std::string("write failed : ")+std::strerror(errno),where);
+				}
+				p += w;
+				n -= static_cast<size_t>(w);
+			}
+		}
+	};
+#endif
+
+}}
+
+
+
+size_t BConfig::serialized_size(const Serialize_options &opt)const{
+	return detail::Serializer(*this,opt).size(*this,0);
+}
+
+
+
+size_t BConfig::serialize(char *buffer, size_t size, const Serialize_options &opt)const{
+	const detail::Serializer s(*this,opt);
+	const size_t n = s.size(*this,0);
+	if(n>size){throw Error_BConfig_serialize("buffer too small, "+std::to_string(n)+" bytes needed","");}
+
+	detail::Buffer_out out{buffer};
+	s.write(*this,0,out);
+	return n;
+}
+
+
+
+std::string BConfig::serialize(const Serialize_options &opt)const{
+	const detail::Serializer s(*this,opt);
+	std::string R(s.size(*this,0),'\0');
+
+	detail::Buffer_out out{R.data()};
+	s.write(*this,0,out);
+	return R;
+}
+
+
+
+#ifdef BCONFIG_SERIALIZE_FD
+void BConfig::serialize(int fd, const Serialize_options &opt)const{
+	detail::Buffered_out<detail::Fd_sink> out(detail::Fd_sink{fd,"fd "+std::to_string(fd)});
+	detail::Serializer(*this,opt).write(*this,0,out);
+	out.flush();
+}
+#endif
+
+
+
+void BConfig::serialize_file(const std::string &path, const Serialize_options &opt)const{
+	std::FILE *f = std::fopen(path.c_str(),"wb");
+	if(f==nullptr){throw Error_OpenFile(path);}
+	std::setvbuf(f,nullptr,_IONBF,0);
+
+	try{
+		detail::Buffered_out<detail::File_sink> out(detail::File_sink{f,path});
+		detail::Serializer(*this,opt).write(*this,0,out);
+		out.flush();
+	}catch(...){
+		std::fclose(f);
+		throw;
+	}
+	if(std::fclose(f)!=0){throw Error_BConfig_serialize(std::string("close failed : ")+std::strerror(errno),path);}
+}
@@ -0,0 +1,184 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+
+#include "BConfig_watcher.hpp"
+#include "helpers/OpenFile.h"
+
+#ifdef __linux__
+#define BCONFIG_INOTIFY
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+using namespace bconfig;
+
+
+
+namespace{
+	Parse_options without_mmap(Parse_options opt){
+		opt.mmap  = false;
+		opt.stats = nullptr; //reloads run in the background, use set_parse_hook to get their stats
+		return opt;
+	}
+
+	//directory and file name of path, for the inotify watch
+	void split_path(const std::string &path, std::string &dir, std::string &name){
+		size_t slash = path.rfind('/');
+		if(slash==std::string::npos){dir="."; name=path; return;}
+		dir  = slash==0 ? "/" : path.substr(0,slash);
+		name = path.substr(slash+1);
+	}
+}
+
+
+
+Watcher::Watcher(const std::string &path, const Parse_options &opt_):p_path(path),opt(without_mmap(opt_)),tree(freeze(BConfig(p_path,opt))){
+
+#ifdef BCONFIG_INOTIFY
+	//watch the directory : editors and deployment tools often replace the file (rename) instead of writing it
+	std::string dir, name;
+	split_path(p_path,dir,name);
+
+	inotify_fd = ::inotify_init1(IN_CLOEXEC);
+	if(inotify_fd<0){throw Error_OpenFile(p_path);}
+	if(::inotify_add_watch(inotify_fd,dir.c_str(),IN_CLOSE_WRITE|IN_MOVED_TO)<0 or ::pipe(wake_fd)!=0){
+		::close(inotify_fd);
+		throw Error_OpenFile(p_path);
+	}
+
+	thread = std::thread(&Watcher::run,this);
+#endif
+}
+
+
+
+Watcher::~Watcher(){
+#ifdef BCONFIG_INOTIFY
+	if(thread.joinable()){
+		char c=0;
+		while(::write(wake_fd[1],&c,1)<0 and errno==EINTR){}
+		thread.join();
+	}
+	::close(wake_fd[0]);
+	::close(wake_fd[1]);
+	::close(inotify_fd);
+#endif
+}
+
+
+
+size_t Watcher::subscribe(std::string_view block_path, callback_t f){
+	Subscriber s;
+	if(!block_path.empty()){s.query = std::make_shared<const Query>(block_path);}
+	s.f = std::move(f);
+
+	std::lock_guard<std::mutex> lock(subscribers_m);
+	s.id = next_id++;
+	subscribers.push_back(std::move(s));
+	return subscribers.back().id;
+}
+
+
+
+void Watcher::unsubscribe(size_t id){
+	std::lock_guard<std::mutex> lock(subscribers_m);
+	for(auto i = subscribers.begin(); i!=subscribers.end(); ++i){
+		if(i->id==id){subscribers.erase(i);return;}
+	}
+}
+
+
+
+void Watcher::on_error(error_callback_t f){
+	std::lock_guard<std::mutex> lock(subscribers_m);
+	error_f = std::move(f);
+}
+
+
+
+bool Watcher::reload(){
+	std::lock_guard<std::mutex> lock(reload_m);
+
+	//parse aside, readers keep using the current tree meanwhile
+	Snapshot next     = freeze(BConfig(p_path,opt));
+	Snapshot previous = tree.load();
+	if(*next==*previous){return false;}
+
+	tree.publish(next);
+	notify(*previous,next);
+	return true;
+}
+
+
+
+void Watcher::notify(const BConfig &previous, const Snapshot &next){
+	std::lock_guard<std::mutex> lock(subscribers_m);
+	for(const Subscriber &s : subscribers){
+		if(s.query){
+			std::vector<const BConfig*> a = s.query->get_blocks(previous,false);
+			std::vector<const BConfig*> b = s.query->get_blocks(*next,false);
+			bool changed = a.size()!=b.size();
+			for(size_t i=0; !changed and i<a.size(); ++i){changed = *a[i]!=*b[i];}
+			if(!changed){continue;}
+		}
+		s.f(next);
+	}
+}
+
+
+
+void Watcher::run(){
+#ifdef BCONFIG_INOTIFY
+	std::string dir, name;
+	split_path(p_path,dir,name);
+
+	alignas(struct inotify_event) char buffer[4096];
+
+	//true if the pending events concern the file, false if nothing is pending
+	auto read_events = [&](){
+		bool R=false;
+		ssize_t n = ::read(inotify_fd,buffer,sizeof(buffer));
+		for(ssize_t i=0; i<n; ){
+			const struct inotify_event *e = reinterpret_cast<const struct inotify_event*>(buffer+i);
+			if(e->mask & IN_Q_OVERFLOW){R=true;}
+			if(e->len>0 and name==e->name){R=true;}
+			i += static_cast<ssize_t>(sizeof(struct inotify_event)+e->len);
+		}
+		return R;
+	};
+
+	while(true){
+		struct pollfd fds[2] = {{inotify_fd,POLLIN,0},{wake_fd[0],POLLIN,0}};
+		if(::poll(fds,2,-1)<0){
+			if(errno==EINTR){continue;}
+			return;
+		}
+		if(fds[1].revents){return;}
+		if(!read_events()){continue;}
+
+		//let the writer finish : wait until no event comes for 50 ms
+		while(true){
+			struct pollfd more[2] = {{inotify_fd,POLLIN,0},{wake_fd[0],POLLIN,0}};
+			int r = ::poll(more,2,50);
+			if(r>0 and more[1].revents){return;}
+			if(r>0){read_events(); continue;}
+			if(r<0 and errno==EINTR){continue;}
+			break;
+		}
+
+		try{
+			reload();
+		}catch(const std::exception &e){
+			std::lock_guard<std::mutex> lock(subscribers_m);
+			if(error_f){error_f(e);}
+		}
+	}
+#endif
+}
@@ -0,0 +1,117 @@
+//============================================================================
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+/**
+ * \file BConfig_watcher.hpp
+ * \brief Reload a configuration file when it changes.
+ * 		A Watcher parses a file, then watches it (inotify on Linux) from a background thread.
+ * 		When the file is written or replaced, the new version is parsed in the background and published only if it differs from the current tree.
+ * 		Readers get the current tree with Watcher::current or Watcher::handle (see BConfig_handle.hpp) : they never wait for a reload,
+ * 		and keep their tree alive as long as they need it.
+ * 		Subscribers registered on a block path (see BConfig_query.hpp) are notified when the blocks at this path changed.
+ *
+ * 		Example :
+ * 		  bconfig::Watcher w("server.conf");
+ * 		  w.subscribe("listen", [](const bconfig::Snapshot &b){ ... reopen sockets ... });
+ * 		  bconfig::Snapshot b = w.current();
+ */
+
+#ifndef BCONFIG_WATCHER_HPP_
+#define BCONFIG_WATCHER_HPP_
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "BConfig.hpp"
+#include "BConfig_handle.hpp"
+#include "BConfig_query.hpp"
+
+
+namespace bconfig{
+
+
+struct Watcher{
+	typedef std::function<void(const Snapshot &)>        callback_t;
+	typedef std::function<void(const std::exception &)> error_callback_t;
+
+	/**\brief parse the file located at path, and start watching it.
+	 * Parse_options::mmap and Parse_options::stats are ignored : a file that is modified in place cannot stay mapped, and reloads run in the background (see set_parse_hook).
+	 * \throw Error_OpenFile if the file cannot be opened or watched
+	 * \throw Error_BConfig_parse if file is invalid*/
+	explicit Watcher(const std::string &path, const Parse_options &opt=Parse_options());
+
+	/**\brief stop watching, wait for the background thread*/
+	~Watcher();
+
+	Watcher(const Watcher &)=delete;
+	Watcher &operator=(const Watcher &)=delete;
+
+	/**\return the watched file path*/
+	const std::string &path()const{return p_path;}
+
+	/**\return the current tree. Never waits for a reload in progress. The tree is immutable and stays alive as long as the pointer.*/
+	Snapshot current()const{return tree.load();}
+
+	/**\return the handle that holds the current tree, for readers that use Handle::read*/
+	const Handle &handle()const{return tree;}
+
+	/**\brief call f(new tree) after each reload that changed the blocks at block_path.
+	 * An empty block_path subscribes to any change. Callbacks are called from the background thread (or from reload),
+	 * they must not call subscribe or unsubscribe.
+	 * \throw Error_BConfig_query if block_path is invalid
+	 * \return an id for unsubscribe*/
+	size_t subscribe(std::string_view block_path, callback_t f);
+
+	/**\brief remove a subscriber. Returns after its callback, if it is running, has returned.*/
+	void unsubscribe(size_t id);
+
+	/**\brief call f on errors of background reloads (e.g., invalid file). By default, they are ignored and the current tree is kept.*/
+	void on_error(error_callback_t f);
+
+	/**\brief parse the file now, publish and notify if it changed. Called by the background thread on file changes.
+	 * \throw Error_OpenFile if the file cannot be opened
+	 * \throw Error_BConfig_parse if file is invalid, the current tree is then kept
+	 * \return true if the tree changed*/
+	bool reload();
+
+
+private:
+	struct Subscriber{
+		size_t                       id;
+		std::shared_ptr<const Query> query; //null : whole tree
+		callback_t                   f;
+	};
+
+	void run(); //background thread
+	void notify(const BConfig &previous, const Snapshot &next);
+
+	std::string   p_path;
+	Parse_options opt;
+
+	Handle tree;
+
+	std::mutex reload_m; //one reload at a time
+
+	std::mutex              subscribers_m; //also held while callbacks run
+	std::vector<Subscriber> subscribers;
+	size_t                  next_id=0;
+	error_callback_t        error_f;
+
+	int inotify_fd=-1;
+	int wake_fd[2]={-1,-1}; //pipe, written by the destructor to stop the thread
+	std::thread thread;
+};
+
+
+}//end namespace bconfig
+
+#endif /* BCONFIG_WATCHER_HPP_ */
@@ -0,0 +1,171 @@
+/*
+ * CompressedFile.cpp
+ *
+ *  Sequential reading of a gzip or zstd compressed file.
+ */
+
+#include "CompressedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#ifdef BCONFIG_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef BCONFIG_ZSTD
+#include <zstd.h>
+#endif
+
+
+struct CompressedFile::Impl{
+	std::string path;
+	Format      format;
+
+#ifdef BCONFIG_ZLIB
+	gzFile gz=nullptr;
+#endif
+
+#ifdef BCONFIG_ZSTD
+	FILE              *file=nullptr;
+	ZSTD_DCtx         *ctx =nullptr;
+	std::vector<char>  in;
+	ZSTD_inBuffer      in_buffer{nullptr,0,0};
+	size_t             pending=0; //last result of ZSTD_decompressStream, not 0 : the current frame is not complete
+	bool               end=false;
+#endif
+};
+
+
+
+CompressedFile::Format CompressedFile::detect(const std::string &path){
+	unsigned char magic[4]={0,0,0,0};
+	FILE *f = std::fopen(path.c_str(),"rb");
+	if(f==nullptr){return Format::none;}
+	const size_t n = std::fread(magic,1,sizeof(magic),f);
+	std::fclose(f);
+
+	if(n>=2 and magic[0]==0x1f and magic[1]==0x8b){return Format::gzip;}
+	if(n>=4 and magic[0]==0x28 and magic[1]==0xb5 and magic[2]==0x2f and magic[3]==0xfd){return Format::zstd;}
+	return Format::none;
+}
+
+
+
+bool CompressedFile::supported(Format f){
+	switch(f){
+		case Format::none : return true;
+#ifdef BCONFIG_ZLIB
+		case Format::gzip : return true;
+#endif
+#ifdef BCONFIG_ZSTD
+		case Format::zstd : return true;
+#endif
+		default : return false;
+	}
+}
+
+
+
+CompressedFile::CompressedFile(const std::string &path, Format f):p(new Impl){
+	p->path   = path;
+	p->format = f;
+	if(!supported(f)){throw Error_OpenFile(path+" (compression not supported by this build)");}
+
+#ifdef BCONFIG_ZLIB
+	if(f==Format::gzip){
+		p->gz = gzopen(path.c_str(),"rb");
+		if(p->gz==nullptr){throw Error_OpenFile_gz(path);}
+		gzbuffer(p->gz,1<<17);
+		return;
+	}
+#endif
+
+#ifdef BCONFIG_ZSTD
+	if(f==Format::zstd){
+		p->file = std::fopen(path.c_str(),"rb");
+		if(p->file==nullptr){throw Error_OpenFile(path);}
+		p->ctx = ZSTD_createDCtx();
+		p->in.resize(ZSTD_DStreamInSize());
+		p->in_buffer.src = p->in.data();
+		return;
+	}
+#endif
+
+	if(f==Format::none){throw Error_OpenFile(path+" (not compressed)");}
+}
+
+
+
+CompressedFile::~CompressedFile(){
+#ifdef BCONFIG_ZLIB
+	if(p->gz){gzclose(p->gz);}
+#endif
+#ifdef BCONFIG_ZSTD
+	if(p->ctx ){ZSTD_freeDCtx(p->ctx);}
+	if(p->file){std::fclose(p->file);}
+#endif
+}
+
+
+
+size_t CompressedFile::read(char *buffer, size_t n){
+#ifdef BCONFIG_ZLIB
+	if(p->format==Format::gzip){
+		//gzread takes an unsigned : read large buffers in pieces
+		size_t R=0;
+		while(R<n){
+			const unsigned want = static_cast<unsigned>(std::min<size_t>(n-R,1u<<30));
+			const int r = gzread(p->gz,buffer+R,want);
+			if(r<0){throw Error_OpenFile_gz(p->path);}
+			if(r==0){break;}
+			R += static_cast<size_t>(r);
+		}
+		return R;
+	}
+#endif
+
+#ifdef BCONFIG_ZSTD
+	if(p->format==Format::zstd){
+		ZSTD_outBuffer out{buffer,n,0};
+		while(out.pos<out.size and !p->end){
+			if(p->in_buffer.pos==p->in_buffer.size){
+				p->in_buffer.size = std::fread(p->in.data(),1,p->in.size(),p->file);
+				p->in_buffer.pos  = 0;
+				if(p->in_buffer.size==0){
+					if(std::ferror(p->file)){throw Error_OpenFile(p->path);}
+					if(p->pending==0){p->end=true; break;}
+					//the decoder may still hold output of the last input, nothing more : the file is truncated
+					const size_t before = out.pos;
+					p->pending = ZSTD_decompressStream(p->ctx,&out,&p->in_buffer);
+					if(ZSTD_isError(p->pending)){throw Error_OpenFile(p->path+" (corrupted zstd data)");}
+					if(out.pos==before and p->pending!=0){throw Error_OpenFile(p->path+" (truncated zstd data)");}
+					continue;
+				}
+			}
+			p->pending = ZSTD_decompressStream(p->ctx,&out,&p->in_buffer);
+			if(ZSTD_isError(p->pending)){throw Error_OpenFile(p->path+" (corrupted zstd data)");}
+		}
+		return out.pos;
+	}
+#endif
+
+	(void)buffer; (void)n;
+	return 0;
+}
+
+
+
+std::string CompressedFile::read_all(){
+	std::string R;
+	size_t size=0;
+	while(true){
+		R.resize(std::max<size_t>(size*2,1<<20));
+		const size_t n = read(&R[size],R.size()-size);
+		size += n;
+		if(size<R.size()){break;} //the file ended before the buffer was full
+	}
+	R.resize(size);
+	return R;
+}
@@ -0,0 +1,55 @@
+/*
+ * CompressedFile.h
+ *
+ *  Sequential reading of a gzip or zstd compressed file.
+ *  gzip needs zlib : define BCONFIG_ZLIB and link with -lz.
+ *  zstd needs libzstd : define BCONFIG_ZSTD and link with -lzstd.
+ */
+
+#ifndef COMPRESSEDFILE_H_
+#define COMPRESSEDFILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "OpenFile.h"
+
+#if defined(BCONFIG_ZLIB) || defined(BCONFIG_ZSTD)
+#define BCONFIG_COMPRESSED //at least one format is supported
+#endif
+
+
+struct CompressedFile{
+	enum struct Format{none, gzip, zstd};
+
+	/**\return the compression of the file located at path, from its first bytes. none if it is not compressed or cannot be read*/
+	static Format detect(const std::string &path);
+
+	/**\return true if this build can read format f*/
+	static bool supported(Format f);
+
+	/**\brief open the file located at path
+	 * \throw Error_OpenFile if the file cannot be opened, or f is not supported*/
+	CompressedFile(const std::string &path, Format f);
+	~CompressedFile();
+
+	CompressedFile(const CompressedFile &)=delete;
+	CompressedFile &operator=(const CompressedFile &)=delete;
+
+	/**\brief decompress the next bytes of the file
+	 * \return the number of bytes written in buffer, at most n. 0 at the end of the file
+	 * \throw Error_OpenFile_gz if the file is corrupted*/
+	size_t read(char *buffer, size_t n);
+
+	/**\return the whole decompressed content*/
+	std::string read_all();
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> p;
+};
+
+
+
+#endif /* COMPRESSEDFILE_H_ */
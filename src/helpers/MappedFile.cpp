@@ -0,0 +1,62 @@
+/*
+ * MappedFile.cpp
+ *
+ *  Read only memory mapping of a whole file.
+ *  On systems without mmap, the file is read in memory instead.
+ */
+
+#include "MappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+
+
+#ifdef MAPPEDFILE_MMAP
+
+MappedFile::MappedFile(const std::string &path){
+	int fd = ::open(path.c_str(),O_RDONLY);
+	if(fd<0){throw Error_OpenFile(path);}
+
+	struct stat st;
+	if(::fstat(fd,&st)!=0){::close(fd);throw Error_OpenFile(path);}
+
+	p_size = static_cast<size_t>(st.st_size);
+	if(p_size==0){::close(fd);return;} //cannot map an empty file
+
+	void *m = ::mmap(nullptr,p_size,PROT_READ,MAP_PRIVATE,fd,0);
+	::close(fd); //the mapping stays valid
+	if(m==MAP_FAILED){p_size=0; throw Error_OpenFile(path);}
+
+	::madvise(m,p_size,MADV_SEQUENTIAL);
+	p_data   = static_cast<const char*>(m);
+	p_mapped = true;
+}
+
+MappedFile::~MappedFile(){
+	if(p_mapped){::munmap(const_cast<char*>(p_data),p_size);}
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path){
+	std::ifstream in(path.c_str(),std::ios::binary);
+	if(!in){throw Error_OpenFile(path);}
+	std::ostringstream s;
+	s << in.rdbuf();
+	p_copy = s.str();
+	p_data = p_copy.data();
+	p_size = p_copy.size();
+}
+
+MappedFile::~MappedFile(){}
+
+#endif
@@ -0,0 +1,39 @@
+/*
+ * MappedFile.h
+ *
+ *  Read only memory mapping of a whole file.
+ *  On systems without mmap, the file is read in memory instead.
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <string_view>
+
+#include "OpenFile.h"
+
+
+struct MappedFile{
+	/**\brief map the file located at path
+	 * \throw Error_OpenFile if the file cannot be opened or mapped*/
+	explicit MappedFile(const std::string &path);
+	~MappedFile();
+
+	MappedFile(const MappedFile &)=delete;
+	MappedFile &operator=(const MappedFile &)=delete;
+
+	const char* data()const{return p_data;}
+	size_t      size()const{return p_size;}
+	std::string_view view()const{return std::string_view(p_data,p_size);}
+
+private:
+	const char *p_data=nullptr;
+	size_t      p_size=0;
+	bool        p_mapped=false; //false : empty file, or fallback copy in p_copy
+	std::string p_copy;
+};
+
+
+
+#endif /* MAPPEDFILE_H_ */
@@ -9,8 +9,12 @@
 #define STRINGCONVERT_H_
 
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <charconv>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
 
 
@@ -19,12 +23,46 @@ namespace bconfig{
 namespace str{
 
 
+	//true for the arithmetic types handled by std::from_chars / std::to_chars (not bool, not characters)
+	template<typename T>
+	struct is_chars_convertible : std::integral_constant<bool,
+		std::is_floating_point<T>::value or (
+			std::is_integral<T>::value
+			and !std::is_same<T,bool       >::value and !std::is_same<T,char         >::value
+			and !std::is_same<T,signed char>::value and !std::is_same<T,unsigned char>::value
+			and !std::is_same<T,wchar_t    >::value and !std::is_same<T,char16_t     >::value
+			and !std::is_same<T,char32_t   >::value
+		)
+	>{};
+
+
+	//strict conversion with std::from_chars : the whole string must be a T, surrounding white spaces and a leading '+' are allowed
+	//return false if s is not a valid T or is out of range
+	template<typename T>
+	inline bool fromChars(std::string_view s, T &R){
+		static_assert(is_chars_convertible<T>::value,"fromChars : unsupported type");
+		const char *ws = " \t\r\n\v\f";
+		size_t b = s.find_first_not_of(ws);
+		if(b==std::string_view::npos){return false;}
+		s = s.substr(b, s.find_last_not_of(ws)-b+1);
+		if(s.size()>1 and s[0]=='+' and s[1]!='-'){s.remove_prefix(1);}
+
+		auto r = std::from_chars(s.data(),s.data()+s.size(),R);
+		return r.ec==std::errc() and r.ptr==s.data()+s.size();
+	}
+
+
 	//from string : convert a string to the template parameter
+	//arithmetic types use fromChars and throw std::invalid_argument if s is not a valid T
 	template<typename T>
 	inline T fromString(const std::string &s){
 		T R;
-		std::stringstream strStream(s);
-		strStream >> R;
+		if constexpr (is_chars_convertible<T>::value){
+			if(!fromChars(s,R)){throw std::invalid_argument("fromString : invalid number " + s);}
+		}else{
+			std::stringstream strStream(s);
+			strStream >> R;
+		}
 		return R;
 	}
 
@@ -46,11 +84,18 @@ namespace str{
 
 
 	//to string : convert a T to a std::string
+	//arithmetic types use std::to_chars (shortest representation that reads back to the same value)
 	template<typename T>
 	inline std::string toString(T const &t){
-		std::ostringstream oss;
-		oss << t;
-		return oss.str();
+		if constexpr (is_chars_convertible<T>::value){
+			char buffer[64];
+			auto r = std::to_chars(buffer,buffer+sizeof(buffer),t);
+			return std::string(buffer,r.ptr);
+		}else{
+			std::ostringstream oss;
+			oss << t;
+			return oss.str();
+		}
 	}
 
 	template<>
@@ -10,6 +10,7 @@
 #define STRINGTOOLS_H_
 
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <sstream>
 #include <deque>
@@ -66,6 +67,22 @@ inline void trim(std::string &source, const std::string &t = " ") {
 	trim_left(source,t);
 }
 
+//same as above, on a view : only the view bounds move
+inline void trim_right(std::string_view &source, std::string_view t= " ") {
+	size_t p = source.find_last_not_of(t);
+	source = source.substr(0, p==std::string_view::npos ? 0 : p+1);
+}
+
+inline void trim_left(std::string_view &source, std::string_view t = " ") {
+	size_t p = source.find_first_not_of(t);
+	source.remove_prefix( p==std::string_view::npos ? source.size() : p );
+}
+
+inline void trim(std::string_view &source, std::string_view t = " ") {
+	trim_right(source,t);
+	trim_left(source,t);
+}
+
 
 
 //--- casse ---
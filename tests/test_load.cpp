@@ -0,0 +1,186 @@
+//============================================================================
+// Name        : test_load.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Test of load_many and Parse_options::include : load_many must give, for each path, the tree or the error of BConfig(path,opt),
+// with small files (shared read buffers), large files, missing files and invalid files, for several threads, mmap, lazy and include.
+// Includes are checked for relative paths, nested and repeated includes, cycles, errors in included files, and files changed on disk.
+// build : g++ -std=c++17 -O2 -pthread -I../src test_load.cpp ../src/BConfig.cpp ../src/helpers/*.cpp
+// The portable code path (no read-ahead, no shared read buffers) is built on a POSIX system by adding -U__unix__ -U__linux__ (and -U__APPLE__ on macOS).
+// usage : ./a.out, returns 0 if every check passed
+
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	size_t failures=0;
+
+	void fail(const std::string &what){
+		if(++failures<=10){std::cerr << "FAIL " << what << "\n";}
+	}
+
+	void write(const std::filesystem::path &p, const std::string &text){
+		std::filesystem::create_directories(p.parent_path());
+		std::ofstream(p,std::ios::binary) << text;
+	}
+
+	//the tree, or the message of the error, of BConfig(path,opt)
+	struct Expected{
+		BConfig     tree;
+		std::string error; //empty : no error
+	};
+
+	Expected parse_one(const std::string &path, const Parse_options &opt){
+		Expected R;
+		try{R.tree = BConfig(path,opt); R.tree.parse_lazy_blocks();}
+		catch(const std::exception &e){R.error = e.what(); if(R.error.empty()){R.error="?";}}
+		return R;
+	}
+
+	std::string describe(const Parse_options &opt){
+		return "threads="+std::to_string(opt.threads)+(opt.mmap ? " mmap" : "")+(opt.lazy ? " lazy" : "")+(opt.include ? " include" : "");
+	}
+
+	void check_load_many(const std::vector<std::string> &paths, const Parse_options &opt){
+		std::vector<Load_result> got = load_many(paths,opt);
+		if(got.size()!=paths.size()){fail(describe(opt)+" : "+std::to_string(got.size())+" results for "+std::to_string(paths.size())+" paths"); return;}
+
+		for(size_t i=0;i<paths.size();++i){
+			const Expected e = parse_one(paths[i],opt);
+			const std::string what = describe(opt)+" "+paths[i];
+			//with Parse_options::lazy, errors inside blocks are thrown when the blocks are parsed
+			std::string err;
+			BConfig b;
+			try{b = std::move(got[i]).get(); b.parse_lazy_blocks();}
+			catch(const std::exception &x){err = x.what();}
+
+			if(!err.empty()){
+				if(e.error.empty()){fail(what+" : unexpected error "+err);}
+				else if(err!=e.error){fail(what+" : error "+err+", expected "+e.error);}
+				continue;
+			}
+			if(!e.error.empty()){fail(what+" : no error, expected "+e.error); continue;}
+			if(!(b==e.tree)){fail(what+" : tree differs from BConfig(path,opt)");}
+		}
+	}
+
+	std::string small_file(size_t i){
+		return "id = "+std::to_string(i)+"\nname = file "+std::to_string(i)+"\nblock{\n  v = "+std::to_string(i*7)+"\n  sub{}\n}\n";
+	}
+
+	std::string large_file(size_t blocks){
+		std::string R;
+		for(size_t i=0;i<blocks;++i){R += "item{\n  id = "+std::to_string(i)+"\n  name = item "+std::to_string(i%13)+"\n}\n";}
+		return R;
+	}
+
+	//expects f to throw an error whose message contains all of parts
+	template<typename F>
+	void expect_error(const std::string &what, F f, const std::vector<std::string> &parts){
+		try{f(); fail(what+" : no error");}
+		catch(const std::exception &e){
+			for(const std::string &p : parts){
+				if(std::string(e.what()).find(p)==std::string::npos){fail(what+" : error "+e.what()+" does not contain "+p);}
+			}
+		}
+	}
+
+	void check_include(const std::filesystem::path &dir){
+		const std::string main = (dir/"main.conf").string();
+		write(dir/"main.conf",        "a = 1\ninclude = conf.d/common.conf\nsrv{\n  include = conf.d/common.conf\n  port = 80\n}\nc = 3\n");
+		write(dir/"conf.d/common.conf","z = 9\ninclude = deep/leaf.conf\n");
+		write(dir/"conf.d/deep/leaf.conf","leaf{\n  w = 1\n}\n");
+
+		for(bool lazy : {false,true}){
+			Parse_options o;
+			o.include = true;
+			o.lazy    = lazy;
+			BConfig b(main,o);
+			const std::string what = std::string("include")+(lazy ? " lazy" : "");
+			if(b.get_unique_value<int>("z")!=9 or b.get_unique_value<int>("c")!=3){fail(what+" : values of the top level");}
+			if(b.get_unique_block("leaf").get_unique_value<int>("w")!=1)           {fail(what+" : nested include");}
+			const BConfig &srv = b.get_unique_block("srv");
+			if(srv.get_unique_value<int>("z")!=9 or srv.count_blocks("leaf")!=1)   {fail(what+" : include in a block");}
+			if(b.has_values("include") or srv.has_values("include"))               {fail(what+" : include lines are kept");}
+		}
+
+		//without the option, include is a value
+		if(BConfig(main).get_unique_value("include")!="conf.d/common.conf"){fail("include disabled : the value is missing");}
+
+		//a changed file is parsed again
+		Parse_options o;
+		o.include = true;
+		write(dir/"conf.d/deep/leaf.conf","leaf{\n  w = 12345\n}\n");
+		if(BConfig(main,o).get_unique_block("leaf").get_unique_value<int>("w")!=12345){fail("include : a changed file is not parsed again");}
+
+		//errors
+		write(dir/"bad.conf","include = conf.d/broken.conf\n");
+		write(dir/"conf.d/broken.conf","ok = 1\noops\n");
+		expect_error("include : error in an included file",[&](){BConfig((dir/"bad.conf").string(),o);},{"broken.conf",", included from ","bad.conf"});
+
+		write(dir/"cycle_a.conf","include = cycle_b.conf\n");
+		write(dir/"cycle_b.conf","include = cycle_a.conf\n");
+		expect_error("include : cycle",[&](){BConfig((dir/"cycle_a.conf").string(),o);},{"include cycle"});
+
+		write(dir/"missing.conf","include = nowhere.conf\n");
+		expect_error("include : missing file",[&](){BConfig((dir/"missing.conf").string(),o);},{"nowhere.conf"});
+
+		clear_include_cache();
+		if(BConfig(main,o).get_unique_block("leaf").get_unique_value<int>("w")!=12345){fail("include : after clear_include_cache");}
+	}
+
+}
+
+
+int main() {
+	const std::filesystem::path dir = std::filesystem::temp_directory_path()/"bconfig_test_load";
+	std::filesystem::remove_all(dir);
+
+	//small files share read buffers, large files get their own, errors stay with their file
+	std::vector<std::string> paths;
+	for(size_t i=0;i<200;++i){
+		paths.push_back((dir/("small_"+std::to_string(i)+".conf")).string());
+		write(paths.back(),small_file(i));
+		if(i%50==7){
+			paths.push_back((dir/("large_"+std::to_string(i)+".conf")).string());
+			write(paths.back(),large_file(20000));
+		}
+	}
+	paths.push_back((dir/"empty.conf").string());       write(paths.back(),"");
+	paths.push_back((dir/"invalid.conf").string());     write(paths.back(),"a = 1\nblock{\n  oops\n}\n");
+	paths.push_back((dir/"missing.conf").string());
+	paths.push_back((dir/"with_include.conf").string()); write(paths.back(),"x = 1\ninclude = small_3.conf\n");
+	paths.push_back(paths[3]); //the same file twice
+
+	for(unsigned threads : {1u,4u}){
+	for(bool mmap : {false,true}){
+	for(bool lazy : {false,true}){
+	for(bool include : {false,true}){
+		Parse_options opt;
+		opt.threads = threads;
+		opt.mmap    = mmap;
+		opt.lazy    = lazy;
+		opt.include = include;
+		check_load_many(paths,opt);
+	}}}}
+	check_load_many({},Parse_options());
+
+	check_include(dir/"include");
+
+	std::filesystem::remove_all(dir);
+	std::cout << failures << " failures\n";
+	return failures==0 ? 0 : 1;
+}
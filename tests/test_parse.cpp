@@ -0,0 +1,309 @@
+//============================================================================
+// Name        : test_parse.cpp
+// Author      : pierre BLAVY
+// Version     : 1.0
+// Copyright   : 2012 LGPL 3.0 or any later version : https://www.gnu.org/licenses/lgpl-3.0-standalone.html
+//============================================================================
+
+// Differential test of the parser : fixed and generated inputs are parsed with every combination of
+// Parse_options::lazy, threads, mmap and decode_values, and compared with a line by line reference parser
+// (the original BConfig::parse algorithm) and with each other (operator==). Invalid inputs must throw the same error at the same line,
+// except with Parse_options::lazy, where an error of another line may come first (top-level lines are parsed before the blocks).
+// build : g++ -std=c++17 -O2 -pthread -I../src test_parse.cpp ../src/BConfig.cpp ../src/BConfig_serialize.cpp ../src/helpers/*.cpp
+// usage : ./a.out [random_inputs=300], returns 0 if every check passed
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BConfig.hpp"
+
+using namespace bconfig;
+
+
+namespace{
+
+	size_t failures=0;
+
+	void fail(const std::string &what, const std::string &input){
+		if(++failures<=10){std::cerr << "FAIL " << what << "\n--- input (" << input.size() << " bytes)\n" << input.substr(0,400) << "\n---\n";}
+	}
+
+
+	//the original parser, line by line : the expected tree, or the expected error
+	struct Reference{
+		struct Node{
+			std::map<std::string,std::vector<std::string>> values; //sorted as bytes, as Serialize_options::Order::sorted
+			std::vector<std::pair<std::string,Node>>       blocks;
+		};
+
+		std::istringstream in;
+		size_t line_num=0;
+
+		std::string error;      //empty : no error
+		size_t      error_line=0;
+
+		explicit Reference(const std::string &text):in(text){}
+
+		static std::string trim(const std::string &s){
+			const size_t b = s.find_first_not_of(" \t");
+			if(b==std::string::npos){return "";}
+			return s.substr(b,s.find_last_not_of(" \t")-b+1);
+		}
+
+		enum struct Mode{undefined,value,open_block,close_block,comment,empty_block};
+
+		//read a trimmed, not empty line : its mode, key and value. Returns the error name, empty if the line is valid
+		static std::string read_line(const std::string &l, Mode &mode, std::string &id, std::string &value){
+			mode = Mode::undefined;
+			for(char c : l){
+				if(c=='#'){
+					if(mode==Mode::undefined){mode=Mode::comment;}
+					break;
+				}
+				if(mode==Mode::undefined){
+					if(c=='='){mode=Mode::value      ;continue;}
+					if(c=='{'){mode=Mode::open_block ;continue;}
+					if(c=='}'){mode=Mode::close_block;continue;}
+					id+=c;
+				}
+				if(mode==Mode::value){value+=c;}
+				if(mode==Mode::open_block){
+					if(c==' ' or c=='\t'){continue;}
+					if(c=='}'){mode=Mode::empty_block;continue;}
+					return "open_blockk";
+				}
+				if(mode==Mode::close_block){
+					if(c==' ' or c=='\t'){continue;}
+					return "close_blockk";
+				}
+				if(mode==Mode::empty_block){
+					if(c==' ' or c=='\t'){continue;}
+					return "empty_blockk";
+				}
+			}
+			return mode==Mode::undefined ? "undefined" : "";
+		}
+
+		//the error name of the line line_num (1 for the first line) of text, empty if it is valid
+		static std::string line_error(const std::string &text, size_t line_num){
+			std::istringstream s(text);
+			std::string l;
+			for(size_t i=0; i<line_num; ++i){if(!std::getline(s,l)){return "";}}
+			l = trim(l);
+			if(l.empty()){return "";}
+			Mode mode;
+			std::string id, value;
+			return read_line(l,mode,id,value);
+		}
+
+		//false on error
+		bool parse(Node &n){
+			std::string l;
+			while(std::getline(in,l)){
+				++line_num;
+				l = trim(l);
+				if(l.empty()){continue;}
+
+				Mode mode;
+				std::string id, value;
+				const std::string e = read_line(l,mode,id,value);
+				if(!e.empty()){return set_error(e);}
+
+				switch(mode){
+					case Mode::comment     : break;
+					case Mode::value       : n.values[trim(id)].push_back(trim(value)); break;
+					case Mode::open_block  : n.blocks.emplace_back(trim(id),Node()); if(!parse(n.blocks.back().second)){return false;} break;
+					case Mode::empty_block : n.blocks.emplace_back(trim(id),Node()); break;
+					case Mode::close_block : return true;
+					case Mode::undefined   : break; //an error
+				}
+			}
+			return true;
+		}
+
+		bool set_error(const std::string &what){error=what; error_line=line_num; return false;}
+
+		//the text of BConfig::serialize with Order::sorted and compact
+		static void write(const Node &n, std::string &R){
+			for(const auto &v : n.values){for(const std::string &s : v.second){R += v.first+"="+s+"\n";}}
+			for(const auto &b : n.blocks){R += b.first+"{\n"; write(b.second,R); R += "}\n";}
+		}
+	};
+
+
+	struct Case{
+		Parse_options opt;
+		bool from_file;
+	};
+
+	std::vector<Case> cases(){
+		std::vector<Case> R;
+		for(bool lazy : {false,true}){
+		for(unsigned threads : {1u,4u}){
+		for(bool decode : {false,true}){
+		for(int source=0; source<3; ++source){ //stream, file read, file mapped
+			Case c;
+			c.opt.lazy          = lazy;
+			c.opt.threads       = threads;
+			c.opt.decode_values = decode;
+			c.opt.mmap          = source==2;
+			c.from_file         = source!=0;
+			R.push_back(c);
+		}}}}
+		return R;
+	}
+
+	std::string describe(const Case &c){
+		return std::string(c.from_file ? (c.opt.mmap ? "mmap" : "file") : "stream")
+			+ (c.opt.lazy ? " lazy" : "") + " threads=" + std::to_string(c.opt.threads) + (c.opt.decode_values ? " decode" : "");
+	}
+
+	//parse input with c, lazy blocks included, and compare with the reference
+	void check(const std::string &input, const std::string &path){
+		Reference ref(input);
+		Reference::Node root;
+		std::string expected;
+		if(ref.parse(root)){Reference::write(root,expected);}
+
+		Serialize_options so;
+		so.order   = Serialize_options::Order::sorted;
+		so.compact = true;
+
+		{std::ofstream(path,std::ios::binary) << input;}
+
+		BConfig first;
+		bool    has_first=false;
+		for(const Case &c : cases()){
+			try{
+				BConfig b;
+				if(c.from_file){
+					b.parse(path,c.opt);
+				}else{
+					std::istringstream in(input);
+					b.parse(in,path,c.opt);
+				}
+				b.parse_lazy_blocks();
+
+				if(!ref.error.empty()){fail(describe(c)+" : no error, expected "+ref.error+" at line "+std::to_string(ref.error_line),input); continue;}
+				if(b.serialize(so)!=expected){fail(describe(c)+" : tree differs from the reference",input); continue;}
+				if(!has_first){first=b; has_first=true;}
+				else if(!(b==first)){fail(describe(c)+" : operator== differs from the first case",input);}
+
+			}catch(const Error_BConfig_parse &e){
+				if(ref.error.empty()){fail(describe(c)+" : unexpected error "+e.what(),input); continue;}
+				if(c.opt.lazy){
+					//top-level lines are parsed before the blocks : the error may not be the first one, but it is at its line
+					const std::string at_line = Reference::line_error(input,e.line);
+					if(at_line.empty() or std::string(e.what()).find(at_line)!=0){fail(describe(c)+" : error "+e.what()+", the line is "+(at_line.empty() ? "valid" : at_line),input);}
+					continue;
+				}
+				if(e.line!=ref.error_line or std::string(e.what()).find(ref.error)!=0){
+					fail(describe(c)+" : error "+e.what()+", expected "+ref.error+" at line "+std::to_string(ref.error_line),input);
+				}
+			}
+		}
+	}
+
+
+	struct Random{
+		uint64_t state;
+		explicit Random(uint64_t seed):state(seed){}
+
+		uint64_t next(){
+			uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z>>27)) * 0x94d049bb133111ebull;
+			return z ^ (z>>31);
+		}
+
+		size_t below(size_t n){return static_cast<size_t>(next()%n);}
+	};
+
+	//a random input : mostly valid lines and balanced blocks, with blanks, comments, long lines and some invalid lines
+	std::string random_input(Random &r, size_t lines){
+		static const char *blanks[]  = {""," ","\t","  \t "};
+		static const char *keys[]    = {"a","key","k e y","n1","x_y","include_not"};
+		static const char *values[]  = {"1","-42","3.5","yes","no","hello world","a=b","0x10","1e3"," spaced ",""};
+		auto blank = [&](){return std::string(blanks[r.below(4)]);};
+
+		std::string R;
+		size_t depth=0;
+		for(size_t i=0;i<lines;++i){
+			const size_t kind = r.below(100);
+			std::string key = keys[r.below(6)];
+			if     (kind<40){R += blank()+key+blank()+"="+blank()+values[r.below(11)]+(r.below(4)==0 ? " # comment" : "")+blank();}
+			else if(kind<55){R += blank()+key+blank()+"{"+blank(); ++depth;}
+			else if(kind<70){if(depth>0){R += blank()+"}"+blank(); --depth;}}
+			else if(kind<75){R += blank()+key+"{"+blank()+"}"+blank();}
+			else if(kind<82){R += blank()+"# a comment { } ="+blank();}
+			else if(kind<90){R += blank();}
+			else if(kind<93){R += key+"="+std::string(5000+r.below(20000),'v');} //lines longer than a scan chunk
+			else if(kind<94){R += blank()+key+blank();}                          //undefined
+			else if(kind<95){R += key+"{ x";}                                     //open_blockk
+			else if(kind<96){R += "} x";}                                         //close_blockk
+			else            {R += key+"=tab\tinside";}
+			R += "\n";
+		}
+		while(depth-->0){R += "}\n";}
+		if(r.below(3)==0 and !R.empty()){R.pop_back();} //no final new line
+		return R;
+	}
+
+	//top-level blocks, large enough to be cut in pieces by Parse_options::threads
+	std::string large_input(size_t blocks, bool error_at_end){
+		std::string R;
+		for(size_t i=0;i<blocks;++i){
+			R += "item{\n  id = "+std::to_string(i)+"\n  name = item "+std::to_string(i%97)+"\n  sub{\n    w = "+std::to_string(i*3)+"\n  }\n  e{}\n}\n";
+			if(i%1000==0){R += "# "+std::string(100,'-')+"\ntop = "+std::to_string(i)+"\n";}
+		}
+		if(error_at_end){R += "item{\n  oops\n}\n";}
+		return R;
+	}
+
+}
+
+
+int main(int argc,char** argv) {
+	const size_t random_inputs = argc>1 ? std::strtoul(argv[1],nullptr,10) : 300;
+	const std::string path = (std::filesystem::temp_directory_path()/"bconfig_test_parse.conf").string();
+
+	//fixed inputs
+	const std::vector<std::string> fixed = {
+		"",
+		"\n\n  \t\n",
+		"a=1",
+		"a = 1\nb=2\na=3\n",
+		" b = 2 # c\na b = x = y\n\tz{ }\nq {\n  w=1\n}\na b=3\n#c\nx#y=1\n",
+		"a=\nb =  \n=c\n",
+		"x{\ny{\nz{\nv=1\n}\n}\n}\nx{}\nx{\n}\n",
+		"a=1\r\nb{\r\n}\r\n",
+		"a{\n b=1\n",                //unclosed block : ends with the input
+		"a=1\n}\nb=2\n",            //close at the top level : the rest is ignored
+		"a=1\nb\n",                 //undefined
+		"a=1\nx{ y\n",              //open_blockk
+		"x{}z\n",                   //empty_blockk
+		"a{\n b{\n  c\n }\n}\n",    //undefined, nested
+		"a=1\n} x\n",               //close_blockk
+		"k="+std::string(100000,'v')+"\nb{\n c=1\n}\n",
+	};
+	for(const std::string &input : fixed){check(input,path);}
+
+	//large inputs, parsed in pieces with threads
+	check(large_input(20000,false),path);
+	check(large_input(20000,true ),path);
+
+	//generated inputs
+	Random r(2024);
+	for(size_t i=0;i<random_inputs;++i){check(random_input(r,1+r.below(i%10==0 ? 3000 : 60)),path);}
+
+	std::filesystem::remove(path);
+	std::cout << fixed.size()+2+random_inputs << " inputs, " << cases().size() << " option sets, " << failures << " failures\n";
+	return failures==0 ? 0 : 1;
+}